@@ -16,12 +16,15 @@
 #include "funcapi.h"
 #include "libpq-fe.h"
 
+#include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
+#include "utils/lsyscache.h"
 #include "utils/numeric.h"
 #include "utils/typcache.h"
 #include "nodes/pg_list.h"
 #include "catalog/namespace.h"
+#include "catalog/pg_proc.h"
 #include "commands/extension.h"
 #include "commands/sequence.h"
 #include "executor/spi.h"
@@ -40,6 +43,7 @@
 #include "distributed/remote_commands.h"
 #include "distributed/placement_connection.h"
 #include "distributed/coordinator_protocol.h"
+#include "distributed/function_utils.h"
 #include "distributed/citus_safe_lib.h"
 
 #define SAVE_AND_PERSIST(c) \
@@ -90,14 +94,22 @@ static LogicalClockShmemData *LogicalClockShmem = NULL;
 static void AdjustLocalClock(ClusterClock *remoteClock);
 static void GetNextNodeClockValue(ClusterClock *nextClusterClockValue);
 static ClusterClock * GetHighestClockInTransaction(List *nodeConnectionList);
-static void AdjustClocksToTransactionHighest(List *nodeConnectionList,
-											 ClusterClock *transactionClockValue);
 static void InitClockAtFirstUse(void);
 static void IncrementClusterClock(ClusterClock *clusterClock);
 static ClusterClock * LargerClock(ClusterClock *clock1, ClusterClock *clock2);
 static ClusterClock * PrepareAndSetTransactionClock(void);
+static void EnsureClockAdjustmentPermitted(void);
 bool EnableClusterClock = true;
 
+/*
+ * Transaction clock picked by citus_get_transaction_clock() in the current
+ * transaction, which the remote transaction-nodes still need to adjust to.
+ * It is sent along with PREPARE TRANSACTION or COMMIT, see
+ * TransactionClockAdjustmentCommand().
+ */
+static bool TransactionClockPending = false;
+static ClusterClock PendingTransactionClock;
+
 
 /*
  * GetEpochTimeAsClock returns the epoch value milliseconds used as logical
@@ -385,30 +397,66 @@ GetHighestClockInTransaction(List *nodeConnectionList)
 
 
 /*
- * AdjustClocksToTransactionHighest Sets the clock value of all the nodes, participated
- * in the PREPARE of the transaction, to the highest clock value of all the nodes.
+ * TransactionClockAdjustmentCommand returns the command that adjusts the clock
+ * of a remote node to the clock of the current transaction, if the transaction
+ * has picked one via citus_get_transaction_clock(). Otherwise, returns NULL.
+ *
+ * The command is sent along with the PREPARE TRANSACTION or COMMIT of the
+ * remote transactions, such that all the nodes move to the transaction clock
+ * before the transaction becomes visible, without an additional round trip.
  */
-static void
-AdjustClocksToTransactionHighest(List *nodeConnectionList,
-								 ClusterClock *transactionClockValue)
+char *
+TransactionClockAdjustmentCommand(void)
 {
-	StringInfo queryToSend = makeStringInfo();
+	if (!TransactionClockPending)
+	{
+		return NULL;
+	}
 
-	/* Set the clock value on participating worker nodes */
-	appendStringInfo(queryToSend,
+	StringInfo command = makeStringInfo();
+	appendStringInfo(command,
 					 "SELECT pg_catalog.citus_internal_adjust_local_clock_to_remote"
 					 "('(%lu, %u)'::pg_catalog.cluster_clock);",
-					 transactionClockValue->logical, transactionClockValue->counter);
+					 PendingTransactionClock.logical, PendingTransactionClock.counter);
 
-	ExecuteRemoteCommandInConnectionList(nodeConnectionList, queryToSend->data);
-	AdjustLocalClock(transactionClockValue);
+	return command->data;
+}
+
+
+/*
+ * EnsureClockAdjustmentPermitted errors out if the current user cannot execute
+ * citus_internal_adjust_local_clock_to_remote(), which the remote nodes run to
+ * adjust to the transaction clock.
+ */
+static void
+EnsureClockAdjustmentPermitted(void)
+{
+	Oid functionId = FunctionOid("pg_catalog",
+								 "citus_internal_adjust_local_clock_to_remote", 1);
+
+	AclResult aclResult = object_aclcheck(ProcedureRelationId, functionId, GetUserId(),
+										  ACL_EXECUTE);
+	if (aclResult != ACLCHECK_OK)
+	{
+		aclcheck_error(aclResult, OBJECT_FUNCTION, get_func_name(functionId));
+	}
+}
+
+
+/*
+ * ResetTransactionClock forgets the clock picked in the current transaction.
+ */
+void
+ResetTransactionClock(void)
+{
+	TransactionClockPending = false;
 }
 
 
 /*
  * PrepareAndSetTransactionClock polls all the transaction-nodes for their respective clocks,
  * picks the highest clock and returns it via UDF citus_get_transaction_clock. All the nodes
- * will now move to this newly negotiated clock.
+ * will move to this newly negotiated clock when the transaction commits.
  */
 static ClusterClock *
 PrepareAndSetTransactionClock(void)
@@ -451,12 +499,36 @@ PrepareAndSetTransactionClock(void)
 		transactionNodeList = lappend(transactionNodeList, connection);
 	}
 
+	/*
+	 * The remote nodes adjust to the transaction clock only along with the
+	 * PREPARE TRANSACTION or COMMIT, where a failure would abort or fail the
+	 * commit on that node. The privilege to adjust the clock is the same on all
+	 * nodes, so check it here instead.
+	 */
+	if (transactionNodeList != NIL)
+	{
+		EnsureClockAdjustmentPermitted();
+	}
+
 	/* Pick the highest logical clock value among all transaction-nodes */
 	ClusterClock *transactionClockValue =
 		GetHighestClockInTransaction(transactionNodeList);
 
-	/* Adjust all the nodes with the new clock value */
-	AdjustClocksToTransactionHighest(transactionNodeList, transactionClockValue);
+	/*
+	 * Adjust the local clock right away, the remote nodes adjust when the
+	 * transaction is prepared or committed on them.
+	 */
+	AdjustLocalClock(transactionClockValue);
+
+	/*
+	 * The local clock has already moved past any clock picked earlier in the
+	 * transaction, so the new one is always the highest.
+	 */
+	if (transactionNodeList != NIL)
+	{
+		PendingTransactionClock = *transactionClockValue;
+		TransactionClockPending = true;
+	}
 
 	return transactionClockValue;
 }
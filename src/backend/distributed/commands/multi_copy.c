@@ -92,6 +92,7 @@
 #include "distributed/resource_lock.h"
 #include "distributed/shard_pruning.h"
 #include "distributed/shared_connection_stats.h"
+#include "distributed/transaction_management.h"
 #include "distributed/version_compat.h"
 #include "distributed/worker_protocol.h"
 #include "distributed/local_multi_copy.h"
@@ -102,6 +103,7 @@
 
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
+#include "mb/pg_wchar.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parse_func.h"
@@ -109,6 +111,7 @@
 #include "tcop/cmdtag.h"
 #include "tsearch/ts_locale.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/syscache.h"
@@ -121,6 +124,9 @@ static const char BinarySignature[11] = "PGCOPY\n\377\r\n\0";
 /* if true, skip validation of JSONB columns during COPY */
 bool SkipJsonbValidationInCopy = true;
 
+/* if true, forward variable length columns of binary COPY input without decoding */
+bool SkipBinaryValidationInCopy = false;
+
 /* custom Citus option for appending to a shard */
 #define APPEND_TO_SHARD_OPTION "append_to_shard"
 
@@ -240,6 +246,9 @@ static void CopyToExistingShards(CopyStmt *copyStatement,
 static bool IsCopyInBinaryFormat(CopyStmt *copyStatement);
 static List * FindJsonbInputColumns(TupleDesc tupleDescriptor,
 									List *inputColumnNameList);
+static List * FindVariableLengthInputColumns(TupleDesc tupleDescriptor,
+											 List *inputColumnNameList);
+static bool IsInputColumn(Form_pg_attribute column, List *inputColumnNameList);
 static List * RemoveOptionFromList(List *optionList, char *optionName);
 static bool BinaryOutputFunctionDefined(Oid typeId);
 static bool BinaryInputFunctionDefined(Oid typeId);
@@ -294,11 +303,18 @@ static void StartPlacementStateCopyCommand(CopyPlacementState *placementState,
 										   CopyOutState copyOutState);
 static void EndPlacementStateCopyCommand(CopyPlacementState *placementState,
 										 CopyOutState copyOutState);
+static void EndPlacementStateCopyCommandList(List *placementStateList,
+											 CopyOutState copyOutState);
+static void EndRemoteCopyOnConnections(List *connectionList, List *shardIdList);
 static void UnclaimCopyConnections(List *connectionStateList);
 static void ShutdownCopyConnectionState(CopyConnectionState *connectionState,
 										CitusCopyDestReceiver *copyDest);
 static SelectStmt * CitusCopySelect(CopyStmt *copyStatement);
 static void CitusCopyTo(CopyStmt *copyStatement, QueryCompletion *completionTag);
+static MultiConnection * StartShardCopyTo(CopyStmt *copyStatement,
+										  ShardInterval *shardInterval,
+										  int connectionFlags);
+static void FinishShardCopyToStart(MultiConnection *connection);
 static int64 ForwardCopyDataFromConnection(CopyOutState copyOutState,
 										   MultiConnection *connection);
 
@@ -609,6 +625,44 @@ CopyToExistingShards(CopyStmt *copyStatement, QueryCompletion *completionTag)
 		}
 	}
 
+	/*
+	 * Along the same lines, when both the input and the COPY to the workers are in
+	 * binary format, we skip decoding variable length columns on the coordinator.
+	 * Those columns are parsed as bytea, which keeps the bytes as they were sent by
+	 * the client, and byteasend forwards the same bytes to the workers, which decode
+	 * them with the actual input function of the column type. The partition column
+	 * is always decoded since we need it to route the row.
+	 *
+	 * Text values are converted between the client and the server encoding while
+	 * decoding, so we only apply the optimisation when the two are the same.
+	 */
+	if (SkipBinaryValidationInCopy && isInputFormatBinary &&
+		copyDest->copyOutState->binary &&
+		pg_get_client_encoding() == GetDatabaseEncoding())
+	{
+		/* get the column indices for variable length columns in the input */
+		List *passthroughColumnIndexList = FindVariableLengthInputColumns(
+			copiedDistributedRelation->rd_att,
+			copyStatement->attlist);
+
+		int passthroughColumnIndex = 0;
+		foreach_int(passthroughColumnIndex, passthroughColumnIndexList)
+		{
+			Form_pg_attribute currentColumn =
+				TupleDescAttr(copiedDistributedRelation->rd_att, passthroughColumnIndex);
+
+			if (passthroughColumnIndex == partitionColumnIndex)
+			{
+				continue;
+			}
+
+			/* keep the binary representation of the column as is */
+			currentColumn->atttypid = BYTEAOID;
+			fmgr_info(F_BYTEASEND,
+					  &copyDest->columnOutputFunctions[passthroughColumnIndex]);
+		}
+	}
+
 	/* initialize copy state to read from COPY data source */
 	CopyFromState copyState = BeginCopyFrom(NULL,
 											copiedDistributedRelation,
@@ -721,32 +775,80 @@ FindJsonbInputColumns(TupleDesc tupleDescriptor, List *inputColumnNameList)
 			continue;
 		}
 
-		if (inputColumnNameList != NIL)
+		if (!IsInputColumn(currentColumn, inputColumnNameList))
 		{
-			ListCell *inputColumnCell = NULL;
-			bool isInputColumn = false;
+			continue;
+		}
 
-			foreach(inputColumnCell, inputColumnNameList)
-			{
-				char *inputColumnName = strVal(lfirst(inputColumnCell));
+		jsonbColumnIndexList = lappend_int(jsonbColumnIndexList, columnIndex);
+	}
 
-				if (namestrcmp(&currentColumn->attname, inputColumnName) == 0)
-				{
-					isInputColumn = true;
-					break;
-				}
-			}
+	return jsonbColumnIndexList;
+}
 
-			if (!isInputColumn)
-			{
-				continue;
-			}
+
+/*
+ * FindVariableLengthInputColumns finds columns in the tuple descriptor that have
+ * a variable length type and appear in inputColumnNameList. If the list is empty
+ * then all variable length columns are returned. Generated columns are never
+ * part of the input and are skipped.
+ */
+static List *
+FindVariableLengthInputColumns(TupleDesc tupleDescriptor, List *inputColumnNameList)
+{
+	List *columnIndexList = NIL;
+	int columnCount = tupleDescriptor->natts;
+
+	for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
+	{
+		Form_pg_attribute currentColumn = TupleDescAttr(tupleDescriptor, columnIndex);
+		if (currentColumn->attisdropped ||
+			currentColumn->attgenerated == ATTRIBUTE_GENERATED_STORED)
+		{
+			continue;
 		}
 
-		jsonbColumnIndexList = lappend_int(jsonbColumnIndexList, columnIndex);
+		if (currentColumn->attlen != -1)
+		{
+			continue;
+		}
+
+		if (!IsInputColumn(currentColumn, inputColumnNameList))
+		{
+			continue;
+		}
+
+		columnIndexList = lappend_int(columnIndexList, columnIndex);
 	}
 
-	return jsonbColumnIndexList;
+	return columnIndexList;
+}
+
+
+/*
+ * IsInputColumn returns whether the given column appears in the input column
+ * name list of a COPY. An empty list means all columns are in the input.
+ */
+static bool
+IsInputColumn(Form_pg_attribute column, List *inputColumnNameList)
+{
+	if (inputColumnNameList == NIL)
+	{
+		return true;
+	}
+
+	ListCell *inputColumnCell = NULL;
+	foreach(inputColumnCell, inputColumnNameList)
+	{
+		char *inputColumnName = strVal(lfirst(inputColumnCell));
+
+		if (namestrcmp(&column->attname, inputColumnName) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
 
@@ -962,23 +1064,40 @@ BinaryInputFunctionDefined(Oid typeId)
 }
 
 
-/* Send copy binary headers to given connections */
+/*
+ * Send copy binary headers to given connections. The headers are serialized into
+ * a separate buffer, such that a row that is already serialized into fe_msgbuf
+ * is kept intact.
+ */
 static void
 SendCopyBinaryHeaders(CopyOutState copyOutState, int64 shardId, List *connectionList)
 {
-	resetStringInfo(copyOutState->fe_msgbuf);
-	AppendCopyBinaryHeaders(copyOutState);
-	SendCopyDataToAll(copyOutState->fe_msgbuf, shardId, connectionList);
+	CopyOutStateData headerOutputState = *copyOutState;
+	headerOutputState.fe_msgbuf = makeStringInfo();
+
+	AppendCopyBinaryHeaders(&headerOutputState);
+	SendCopyDataToAll(headerOutputState.fe_msgbuf, shardId, connectionList);
+
+	pfree(headerOutputState.fe_msgbuf->data);
+	pfree(headerOutputState.fe_msgbuf);
 }
 
 
-/* Send copy binary footers to given connections */
+/*
+ * Send copy binary footers to given connections. Like the headers, the footers
+ * do not overwrite fe_msgbuf.
+ */
 static void
 SendCopyBinaryFooters(CopyOutState copyOutState, int64 shardId, List *connectionList)
 {
-	resetStringInfo(copyOutState->fe_msgbuf);
-	AppendCopyBinaryFooters(copyOutState);
-	SendCopyDataToAll(copyOutState->fe_msgbuf, shardId, connectionList);
+	CopyOutStateData footerOutputState = *copyOutState;
+	footerOutputState.fe_msgbuf = makeStringInfo();
+
+	AppendCopyBinaryFooters(&footerOutputState);
+	SendCopyDataToAll(footerOutputState.fe_msgbuf, shardId, connectionList);
+
+	pfree(footerOutputState.fe_msgbuf->data);
+	pfree(footerOutputState.fe_msgbuf);
 }
 
 
@@ -1125,21 +1244,53 @@ SendCopyDataToPlacement(StringInfo dataBuffer, int64 shardId, MultiConnection *c
 void
 EndRemoteCopy(int64 shardId, List *connectionList)
 {
-	ListCell *connectionCell = NULL;
+	uint64 copiedShardId = (uint64) shardId;
+	List *shardIdList = NIL;
 
-	foreach(connectionCell, connectionList)
+	MultiConnection *connection = NULL;
+	foreach_ptr(connection, connectionList)
 	{
-		MultiConnection *connection = (MultiConnection *) lfirst(connectionCell);
-		bool raiseInterrupts = true;
+		shardIdList = lappend(shardIdList, &copiedShardId);
+	}
+
+	EndRemoteCopyOnConnections(connectionList, shardIdList);
+}
 
+
+/*
+ * EndRemoteCopyOnConnections ends the COPY input on all connections, and unclaims
+ * connections. shardIdList contains a pointer to the id of the shard that is copied
+ * over the connection at the same position in connectionList, which is used in
+ * error messages. This reports an error on failure.
+ *
+ * The COPY input is ended on all connections first and we then wait for all of
+ * them in parallel, such that the time spent here is that of the slowest node
+ * rather than the sum of all nodes.
+ */
+static void
+EndRemoteCopyOnConnections(List *connectionList, List *shardIdList)
+{
+	bool raiseInterrupts = true;
+
+	MultiConnection *connection = NULL;
+	uint64 *shardIdPointer = NULL;
+	forboth_ptr(connection, connectionList, shardIdPointer, shardIdList)
+	{
 		/* end the COPY input */
-		if (!PutRemoteCopyEnd(connection, NULL))
+		if (!StartRemoteCopyEnd(connection, NULL))
 		{
 			ereport(ERROR, (errcode(ERRCODE_IO_ERROR),
-							errmsg("failed to COPY to shard " INT64_FORMAT " on %s:%d",
-								   shardId, connection->hostname, connection->port)));
+							errmsg("failed to COPY to shard " UINT64_FORMAT " on %s:%d",
+								   *shardIdPointer, connection->hostname,
+								   connection->port)));
 		}
+	}
 
+	/* send the remaining data and wait for the COPY commands to finish */
+	WaitForAllConnections(connectionList, raiseInterrupts);
+
+	foreach_ptr(connection, connectionList)
+	{
 		/* check whether there were any COPY errors */
 		PGresult *result = GetRemoteCommandResult(connection, raiseInterrupts);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK)
@@ -2159,6 +2310,13 @@ CitusCopyDestReceiverStartup(DestReceiver *dest, int operation,
 	copyDest->shardStateHash = CreateShardStateHash(TopTransactionContext);
 	copyDest->connectionStateHash = CreateConnectionStateHash(TopTransactionContext);
 
+	/*
+	 * Prepare routing of tuples to shards once, after we acquired the shard
+	 * metadata locks and hence have an up-to-date cache entry.
+	 */
+	copyDest->shardRoutingInfo =
+		CreateShardRoutingInfo(GetCitusTableCacheEntry(tableId));
+
 	RecordRelationAccessIfNonDistTable(tableId, PLACEMENT_ACCESS_DML);
 
 	/*
@@ -2328,6 +2486,21 @@ CitusSendTupleToPlacements(TupleTableSlot *slot, CitusCopyDestReceiver *copyDest
 		WriteTupleToLocalShard(slot, copyDest, shardId, shardState->copyOutState);
 	}
 
+	/*
+	 * Serialize the row only once, every remote placement of the shard gets the
+	 * same bytes. That matters for reference tables and tables with replication
+	 * factor > 1, where we would otherwise run the output functions of all the
+	 * columns once per placement.
+	 */
+	StringInfo serializedRow = copyOutState->fe_msgbuf;
+	if (shardState->placementStateList != NIL)
+	{
+		resetStringInfo(serializedRow);
+		AppendCopyRowData(columnValues, columnNulls, tupleDescriptor,
+						  copyOutState, columnOutputFunctions,
+						  columnCoercionPaths);
+	}
+
 	foreach(placementStateCell, shardState->placementStateList)
 	{
 		CopyPlacementState *currentPlacementState = lfirst(placementStateCell);
@@ -2372,13 +2545,8 @@ CitusSendTupleToPlacements(TupleTableSlot *slot, CitusCopyDestReceiver *copyDest
 		else if (currentPlacementState != activePlacementState)
 		{
 			/* buffer data */
-			StringInfo copyBuffer = copyOutState->fe_msgbuf;
-			resetStringInfo(copyBuffer);
-			AppendCopyRowData(columnValues, columnNulls, tupleDescriptor,
-							  copyOutState, columnOutputFunctions,
-							  columnCoercionPaths);
-			appendBinaryStringInfo(currentPlacementState->data, copyBuffer->data,
-								   copyBuffer->len);
+			appendBinaryStringInfo(currentPlacementState->data, serializedRow->data,
+								   serializedRow->len);
 		}
 		else
 		{
@@ -2388,10 +2556,7 @@ CitusSendTupleToPlacements(TupleTableSlot *slot, CitusCopyDestReceiver *copyDest
 
 		if (sendTupleOverConnection)
 		{
-			resetStringInfo(copyOutState->fe_msgbuf);
-			AppendCopyRowData(columnValues, columnNulls, tupleDescriptor,
-							  copyOutState, columnOutputFunctions, columnCoercionPaths);
-			SendCopyDataToPlacement(copyOutState->fe_msgbuf, shardId,
+			SendCopyDataToPlacement(serializedRow, shardId,
 									connectionState->connection);
 		}
 	}
@@ -2526,8 +2691,8 @@ ShardIdForTuple(CitusCopyDestReceiver *copyDest, Datum *columnValues, bool *colu
 	int partitionColumnIndex = copyDest->partitionColumnIndex;
 	Datum partitionColumnValue = 0;
 	CopyCoercionData *columnCoercionPaths = copyDest->columnCoercionPaths;
-	CitusTableCacheEntry *cacheEntry =
-		GetCitusTableCacheEntry(copyDest->distributedRelationId);
+	ShardRoutingInfo *shardRoutingInfo = copyDest->shardRoutingInfo;
+	CitusTableCacheEntry *cacheEntry = shardRoutingInfo->cacheEntry;
 
 	if (IsCitusTableTypeCacheEntry(cacheEntry, APPEND_DISTRIBUTED))
 	{
@@ -2575,15 +2740,15 @@ ShardIdForTuple(CitusCopyDestReceiver *copyDest, Datum *columnValues, bool *colu
 	 * For reference table, this function blindly returns the tables single
 	 * shard.
 	 */
-	ShardInterval *shardInterval = FindShardInterval(partitionColumnValue, cacheEntry);
-	if (shardInterval == NULL)
+	int shardIndex = RouteDistributionValue(shardRoutingInfo, partitionColumnValue);
+	if (shardIndex == INVALID_SHARD_INDEX)
 	{
 		ereport(ERROR, (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 						errmsg("could not find shard for partition column "
 							   "value")));
 	}
 
-	return shardInterval->shardId;
+	return cacheEntry->sortedShardIntervalArray[shardIndex]->shardId;
 }
 
 
@@ -2608,6 +2773,28 @@ CitusCopyDestReceiverShutdown(DestReceiver *destReceiver)
 
 	PG_TRY();
 	{
+		List *activePlacementStateList = NIL;
+
+		foreach(connectionStateCell, connectionStateList)
+		{
+			CopyConnectionState *connectionState =
+				(CopyConnectionState *) lfirst(connectionStateCell);
+
+			if (connectionState->activePlacementState != NULL)
+			{
+				activePlacementStateList =
+					lappend(activePlacementStateList,
+							connectionState->activePlacementState);
+			}
+		}
+
+		/*
+		 * End the ongoing COPY commands on all connections at once, such that we
+		 * wait for the nodes in parallel rather than one after the other.
+		 */
+		EndPlacementStateCopyCommandList(activePlacementStateList,
+										 copyDest->copyOutState);
+
 		foreach(connectionStateCell, connectionStateList)
 		{
 			CopyConnectionState *connectionState =
@@ -2722,10 +2909,10 @@ ShutdownCopyConnectionState(CopyConnectionState *connectionState,
 	CopyStmt *copyStatement = copyDest->copyStatement;
 	dlist_iter iter;
 
+	/* the COPY for the active placement is already ended by the caller */
 	CopyPlacementState *activePlacementState = connectionState->activePlacementState;
 	if (activePlacementState != NULL)
 	{
-		EndPlacementStateCopyCommand(activePlacementState, copyOutState);
 		if (!copyDest->isPublishable)
 		{
 			ResetReplicationOriginRemoteSession(
@@ -2985,6 +3172,13 @@ CitusCopySelect(CopyStmt *copyStatement)
 /*
  * CitusCopyTo runs a COPY .. TO STDOUT command on each shard to do a full
  * table dump.
+ *
+ * Shards are still forwarded to the client one at a time, but while the rows
+ * of a shard are being forwarded the COPY of the next shard is already sent
+ * over another connection. That way the worker of the next shard starts
+ * producing rows while we are busy with the current one, and the amount of
+ * data it can get ahead of us is bounded by the socket buffers of that single
+ * connection.
  */
 static void
 CitusCopyTo(CopyStmt *copyStatement, QueryCompletion *completionTag)
@@ -3006,82 +3200,150 @@ CitusCopyTo(CopyStmt *copyStatement, QueryCompletion *completionTag)
 
 	List *shardIntervalList = LoadShardIntervalList(relationId);
 
+	/*
+	 * Within a transaction block, placements might have been accessed over
+	 * connections that we need to keep using, so we only prefetch the next
+	 * shard when COPY is the only statement of the transaction.
+	 */
+	bool prefetchNextShard = !IsMultiStatementTransaction();
+	MultiConnection *nextConnection = NULL;
+
 	foreach(shardIntervalCell, shardIntervalList)
 	{
 		ShardInterval *shardInterval = lfirst(shardIntervalCell);
-		List *shardPlacementList = ActiveShardPlacementList(shardInterval->shardId);
-		ListCell *shardPlacementCell = NULL;
-		int placementIndex = 0;
+		MultiConnection *connection = nextConnection;
+		int connectionFlags = 0;
 
-		StringInfo copyCommand = ConstructCopyStatement(copyStatement,
-														shardInterval->shardId);
+		if (connection == NULL)
+		{
+			connection = StartShardCopyTo(copyStatement, shardInterval, connectionFlags);
+		}
 
-		foreach(shardPlacementCell, shardPlacementList)
+		if (shardIntervalCell == list_head(shardIntervalList))
 		{
-			ShardPlacement *shardPlacement = lfirst(shardPlacementCell);
-			int connectionFlags = 0;
-			char *userName = NULL;
-			const bool raiseErrors = true;
+			/* remove header after the first shard */
+			copyStatement->options =
+				RemoveOptionFromList(copyStatement->options, "header");
+		}
 
-			MultiConnection *connection = GetPlacementConnection(connectionFlags,
-																 shardPlacement,
-																 userName);
+		ListCell *nextShardIntervalCell = lnext(shardIntervalList, shardIntervalCell);
+		nextConnection = NULL;
+
+		if (prefetchNextShard && nextShardIntervalCell != NULL)
+		{
+			ShardInterval *nextShardInterval = lfirst(nextShardIntervalCell);
 
 			/*
-			 * This code-path doesn't support optional connections, so we don't expect
-			 * NULL connections.
+			 * Prefetching is only an optimization, so we do not want to wait
+			 * for or error out on hitting the shared connection limit. If we
+			 * cannot get a connection, the next shard is fetched once we are
+			 * done with the current one.
 			 */
-			Assert(connection != NULL);
+			nextConnection = StartShardCopyTo(copyStatement, nextShardInterval,
+											  OPTIONAL_CONNECTION);
+		}
 
-			if (placementIndex == list_length(shardPlacementList) - 1)
-			{
-				/* last chance for this shard */
-				MarkRemoteTransactionCritical(connection);
-			}
+		FinishShardCopyToStart(connection);
 
-			if (PQstatus(connection->pgConn) != CONNECTION_OK)
-			{
-				ReportConnectionError(connection, ERROR);
-				continue;
-			}
+		tuplesSent += ForwardCopyDataFromConnection(copyOutState, connection);
 
-			RemoteTransactionBeginIfNecessary(connection);
+		UnclaimConnection(connection);
+	}
 
-			if (!SendRemoteCommand(connection, copyCommand->data))
-			{
-				ReportConnectionError(connection, ERROR);
-				continue;
-			}
+	SendCopyEnd(copyOutState);
 
-			PGresult *result = GetRemoteCommandResult(connection, raiseErrors);
-			if (PQresultStatus(result) != PGRES_COPY_OUT)
-			{
-				ReportResultError(connection, result, ERROR);
-			}
+	table_close(distributedRelation, AccessShareLock);
 
-			PQclear(result);
+	if (completionTag != NULL)
+	{
+		CompleteCopyQueryTagCompat(completionTag, tuplesSent);
+	}
+}
 
-			tuplesSent += ForwardCopyDataFromConnection(copyOutState, connection);
 
-			break;
+/*
+ * StartShardCopyTo sends a COPY .. TO STDOUT command for the given shard over a
+ * connection to one of its placements, without waiting for the result. The
+ * connection is claimed exclusively, such that the next shard does not end up
+ * on the same, busy connection. The caller should unclaim it once all data is
+ * received.
+ *
+ * The function returns NULL if connectionFlags contains OPTIONAL_CONNECTION and
+ * no connection could be established.
+ */
+static MultiConnection *
+StartShardCopyTo(CopyStmt *copyStatement, ShardInterval *shardInterval,
+				 int connectionFlags)
+{
+	List *shardPlacementList = ActiveShardPlacementList(shardInterval->shardId);
+	ListCell *shardPlacementCell = NULL;
+	int placementIndex = 0;
+
+	StringInfo copyCommand = ConstructCopyStatement(copyStatement,
+													shardInterval->shardId);
+
+	foreach(shardPlacementCell, shardPlacementList)
+	{
+		ShardPlacement *shardPlacement = lfirst(shardPlacementCell);
+		char *userName = NULL;
+
+		MultiConnection *connection = GetPlacementConnection(connectionFlags,
+															 shardPlacement,
+															 userName);
+		if (connection == NULL)
+		{
+			/* connection can only be NULL for optional connections */
+			Assert((connectionFlags & OPTIONAL_CONNECTION));
+
+			return NULL;
 		}
 
-		if (shardIntervalCell == list_head(shardIntervalList))
+		if (placementIndex == list_length(shardPlacementList) - 1)
 		{
-			/* remove header after the first shard */
-			copyStatement->options =
-				RemoveOptionFromList(copyStatement->options, "header");
+			/* last chance for this shard */
+			MarkRemoteTransactionCritical(connection);
 		}
+
+		if (PQstatus(connection->pgConn) != CONNECTION_OK)
+		{
+			ReportConnectionError(connection, ERROR);
+			continue;
+		}
+
+		RemoteTransactionBeginIfNecessary(connection);
+
+		if (!SendRemoteCommand(connection, copyCommand->data))
+		{
+			ReportConnectionError(connection, ERROR);
+			continue;
+		}
+
+		ClaimConnectionExclusively(connection);
+
+		return connection;
 	}
 
-	SendCopyEnd(copyOutState);
+	ereport(ERROR, (errmsg("no active placements were found for shard " UINT64_FORMAT,
+						   shardInterval->shardId)));
+}
 
-	table_close(distributedRelation, AccessShareLock);
 
-	if (completionTag != NULL)
+/*
+ * FinishShardCopyToStart waits for the worker to switch the connection into
+ * COPY OUT mode after StartShardCopyTo.
+ */
+static void
+FinishShardCopyToStart(MultiConnection *connection)
+{
+	const bool raiseErrors = true;
+
+	PGresult *result = GetRemoteCommandResult(connection, raiseErrors);
+	if (PQresultStatus(result) != PGRES_COPY_OUT)
 	{
-		CompleteCopyQueryTagCompat(completionTag, tuplesSent);
+		ReportResultError(connection, result, ERROR);
 	}
+
+	PQclear(result);
 }
 
 
@@ -3866,17 +4128,41 @@ static void
 EndPlacementStateCopyCommand(CopyPlacementState *placementState,
 							 CopyOutState copyOutState)
 {
-	MultiConnection *connection = placementState->connectionState->connection;
-	uint64 shardId = placementState->shardState->shardId;
+	EndPlacementStateCopyCommandList(list_make1(placementState), copyOutState);
+}
+
+
+/*
+ * EndPlacementStateCopyCommandList ends the COPY for all the given placements,
+ * which are expected to be on different connections. It also sends binary
+ * footers if this is a binary COPY. The nodes finish their COPY commands in
+ * parallel, see EndRemoteCopyOnConnections.
+ */
+static void
+EndPlacementStateCopyCommandList(List *placementStateList, CopyOutState copyOutState)
+{
+	List *connectionList = NIL;
+	List *shardIdList = NIL;
 	bool binaryCopy = copyOutState->binary;
 
-	/* send footers and end copy command */
-	if (binaryCopy)
+	CopyPlacementState *placementState = NULL;
+	foreach_ptr(placementState, placementStateList)
 	{
-		SendCopyBinaryFooters(copyOutState, shardId, list_make1(connection));
+		MultiConnection *connection = placementState->connectionState->connection;
+		CopyShardState *shardState = placementState->shardState;
+
+		/* send footers before ending the copy command */
+		if (binaryCopy)
+		{
+			SendCopyBinaryFooters(copyOutState, shardState->shardId,
+								  list_make1(connection));
+		}
+
+		connectionList = lappend(connectionList, connection);
+		shardIdList = lappend(shardIdList, &shardState->shardId);
 	}
 
-	EndRemoteCopy(shardId, list_make1(connection));
+	EndRemoteCopyOnConnections(connectionList, shardIdList);
 }
 
 
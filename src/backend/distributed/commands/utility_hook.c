@@ -1139,7 +1139,7 @@ ExecuteDistributedDDLJob(DDLJob *ddlJob)
 	{
 		if (shouldSyncMetadata)
 		{
-			SendCommandToWorkersWithMetadata(DISABLE_DDL_PROPAGATION);
+			List *commandList = list_make1(DISABLE_DDL_PROPAGATION);
 
 			char *currentSearchPath = CurrentSearchPath();
 
@@ -1149,14 +1149,19 @@ ExecuteDistributedDDLJob(DDLJob *ddlJob)
 			 */
 			if (currentSearchPath != NULL)
 			{
-				SendCommandToWorkersWithMetadata(
-					psprintf("SET LOCAL search_path TO %s;", currentSearchPath));
+				commandList = lappend(commandList,
+									  psprintf("SET LOCAL search_path TO %s;",
+											   currentSearchPath));
 			}
 
 			if (ddlJob->metadataSyncCommand != NULL)
 			{
-				SendCommandToWorkersWithMetadata((char *) ddlJob->metadataSyncCommand);
+				commandList = lappend(commandList,
+									  (char *) ddlJob->metadataSyncCommand);
 			}
+
+			/* send all the commands to each worker in a single round trip */
+			SendCommandListToWorkersWithMetadata(commandList);
 		}
 
 		ExecuteUtilityTaskList(ddlJob->taskList, localExecutionSupported);
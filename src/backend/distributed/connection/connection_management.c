@@ -1471,6 +1471,7 @@ AfterXactHostConnectionHandling(ConnectionHashEntry *entry, bool isCommit)
  * - Connection has a replication origin setup
  * - A transaction is still in progress (usually because we are cancelling a distributed transaction)
  * - A connection reached its maximum lifetime
+ * - Other backends are waiting for a connection slot on the same node
  */
 static bool
 ShouldShutdownConnection(MultiConnection *connection, const int cachedConnectionCount)
@@ -1491,7 +1492,8 @@ ShouldShutdownConnection(MultiConnection *connection, const int cachedConnection
 		   connection->isReplicationOriginSessionSetup ||
 		   (MaxCachedConnectionLifetime >= 0 &&
 			MillisecondsToTimeout(connection->connectionEstablishmentStart,
-								  MaxCachedConnectionLifetime) <= 0);
+								  MaxCachedConnectionLifetime) <= 0) ||
+		   SharedConnectionHasWaiters(connection->hostname, connection->port);
 }
 
 
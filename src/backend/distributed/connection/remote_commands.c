@@ -753,9 +753,30 @@ PutRemoteCopyData(MultiConnection *connection, const char *buffer, int nbytes)
 bool
 PutRemoteCopyEnd(MultiConnection *connection, const char *errormsg)
 {
-	PGconn *pgConn = connection->pgConn;
 	bool allowInterrupts = true;
 
+	if (!StartRemoteCopyEnd(connection, errormsg))
+	{
+		return false;
+	}
+
+	return FinishConnectionIO(connection, allowInterrupts);
+}
+
+
+/*
+ * StartRemoteCopyEnd is like PutRemoteCopyEnd(), but it does not wait for the
+ * pending COPY data to be sent. That allows ending the COPY on multiple
+ * connections, and then finishing the IO on all of them in parallel via
+ * WaitForAllConnections().
+ *
+ * Returns false if PQputCopyEnd() failed, true otherwise.
+ */
+bool
+StartRemoteCopyEnd(MultiConnection *connection, const char *errormsg)
+{
+	PGconn *pgConn = connection->pgConn;
+
 	if (PQstatus(pgConn) != CONNECTION_OK)
 	{
 		return false;
@@ -773,7 +794,7 @@ PutRemoteCopyEnd(MultiConnection *connection, const char *errormsg)
 
 	connection->copyBytesWrittenSinceLastFlush = 0;
 
-	return FinishConnectionIO(connection, allowInterrupts);
+	return true;
 }
 
 
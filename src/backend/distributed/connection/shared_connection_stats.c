@@ -37,6 +37,7 @@
 #include "distributed/tuplestore.h"
 #include "utils/builtins.h"
 #include "common/hashfn.h"
+#include "port/atomics.h"
 #include "storage/ipc.h"
 
 
@@ -81,7 +82,19 @@ typedef struct SharedConnStatsHashEntry
 {
 	SharedConnStatsHashKey key;
 
-	int connectionCount;
+	/*
+	 * The counters are atomics, such that backends can reserve and release
+	 * connection slots while holding sharedConnectionHashLock in shared mode.
+	 */
+	pg_atomic_uint32 connectionCount;
+
+	/*
+	 * Number of backends that are blocked in WaitLoopForSharedConnection() for
+	 * a slot on this node. Backends use this to decide whether to give their
+	 * idle cached connections back to the pool at the end of a transaction,
+	 * and whether to wake up the waiters when they release a slot.
+	 */
+	pg_atomic_uint32 waitingBackendCount;
 } SharedConnStatsHashEntry;
 
 
@@ -112,6 +125,15 @@ static ConnectionStatsSharedData *ConnectionStatsSharedState = NULL;
 
 static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
 
+/*
+ * Key of the node that this backend waits for a connection slot on, valid while
+ * RegisteredAsConnectionWaiter is set. We keep the registration in backend-local
+ * memory such that it can be undone when the backend exits while waiting, see
+ * UnregisterSharedConnectionWaiter().
+ */
+static SharedConnStatsHashKey WaitingForConnectionKey;
+static bool RegisteredAsConnectionWaiter = false;
+
 
 /* local function declarations */
 static void StoreAllRemoteConnectionStats(Tuplestorestate *tupleStore, TupleDesc
@@ -119,6 +141,14 @@ static void StoreAllRemoteConnectionStats(Tuplestorestate *tupleStore, TupleDesc
 static void LockConnectionSharedMemory(LWLockMode lockMode);
 static void UnLockConnectionSharedMemory(void);
 static bool ShouldWaitForConnection(int currentConnectionCount);
+static void InitializeSharedConnStatsKey(SharedConnStatsHashKey *connKey,
+										 const char *hostname, int port);
+static SharedConnStatsHashEntry * LockAndFindSharedConnStatsEntry(
+	SharedConnStatsHashKey *connKey, bool createIfMissing, bool *entryCreated);
+static void RemoveSharedConnStatsEntryIfUnused(SharedConnStatsHashKey *connKey);
+static bool TryReserveSharedConnectionSlot(SharedConnStatsHashEntry *connectionEntry,
+										   int connectionLimit);
+static void RegisterSharedConnectionWaiter(const char *hostname, int port);
 static uint32 SharedConnectionHashHash(const void *key, Size keysize);
 static int SharedConnectionHashCompare(const void *a, const void *b, Size keysize);
 
@@ -179,7 +209,8 @@ StoreAllRemoteConnectionStats(Tuplestorestate *tupleStore, TupleDesc tupleDescri
 		values[0] = PointerGetDatum(cstring_to_text(connectionEntry->key.hostname));
 		values[1] = Int32GetDatum(connectionEntry->key.port);
 		values[2] = PointerGetDatum(cstring_to_text(databaseName));
-		values[3] = Int32GetDatum(connectionEntry->connectionCount);
+		values[3] = Int32GetDatum(
+			pg_atomic_read_u32(&connectionEntry->connectionCount));
 
 		tuplestore_putvalues(tupleStore, tupleDescriptor, values, isNulls);
 	}
@@ -255,17 +286,329 @@ GetLocalSharedPoolSize(void)
 void
 WaitLoopForSharedConnection(const char *hostname, int port)
 {
-	while (!TryToIncrementSharedConnectionCounter(hostname, port))
+	if (TryToIncrementSharedConnectionCounter(hostname, port))
 	{
-		CHECK_FOR_INTERRUPTS();
+		return;
+	}
+
+	/*
+	 * Let the other backends know that we are waiting for a slot on this node,
+	 * such that they do not keep their idle connections to it cached at the end
+	 * of their transactions and that they wake us up when they release a slot.
+	 * See SharedConnectionHasWaiters() and DecrementSharedConnectionCounter().
+	 */
+	RegisterSharedConnectionWaiter(hostname, port);
 
-		WaitForSharedConnection();
+	PG_TRY();
+	{
+		do {
+			CHECK_FOR_INTERRUPTS();
+
+			WaitForSharedConnection();
+		} while (!TryToIncrementSharedConnectionCounter(hostname, port));
 	}
+	PG_CATCH();
+	{
+		UnregisterSharedConnectionWaiter();
+
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	UnregisterSharedConnectionWaiter();
 
 	ConditionVariableCancelSleep();
 }
 
 
+/*
+ * InitializeSharedConnStatsKey fills the hash key for the given hostname/port
+ * and the current database.
+ */
+static void
+InitializeSharedConnStatsKey(SharedConnStatsHashKey *connKey, const char *hostname,
+							 int port)
+{
+	if (strlen(hostname) > MAX_NODE_LENGTH)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						errmsg("hostname exceeds the maximum length of %d",
+							   MAX_NODE_LENGTH)));
+	}
+
+	memset(connKey, 0, sizeof(SharedConnStatsHashKey));
+	strlcpy(connKey->hostname, hostname, MAX_NODE_LENGTH);
+	connKey->port = port;
+	connKey->databaseOid = MyDatabaseId;
+}
+
+
+/*
+ * LockAndFindSharedConnStatsEntry locks the shared memory and returns the
+ * entry for the given key.
+ *
+ * The counters in the entries are atomics, so the common case where the entry
+ * already exists only requires a shared lock, which lets backends that open and
+ * close connections to the same node proceed concurrently. The shared lock only
+ * guarantees that the entry is not removed while we use it. We fall back to an
+ * exclusive lock when the entry has to be created.
+ *
+ * If createIfMissing is false and there is no entry, or there is no space left
+ * in the hash, the function returns NULL without holding the lock. Otherwise,
+ * the caller should call UnLockConnectionSharedMemory() when it is done with
+ * the entry.
+ */
+static SharedConnStatsHashEntry *
+LockAndFindSharedConnStatsEntry(SharedConnStatsHashKey *connKey, bool createIfMissing,
+								bool *entryCreated)
+{
+	bool entryFound = false;
+
+	*entryCreated = false;
+
+	LockConnectionSharedMemory(LW_SHARED);
+
+	SharedConnStatsHashEntry *connectionEntry =
+		hash_search(SharedConnStatsHash, connKey, HASH_FIND, &entryFound);
+	if (entryFound)
+	{
+		return connectionEntry;
+	}
+
+	UnLockConnectionSharedMemory();
+
+	if (!createIfMissing)
+	{
+		return NULL;
+	}
+
+	LockConnectionSharedMemory(LW_EXCLUSIVE);
+
+	/*
+	 * As the hash map is allocated in shared memory, it doesn't rely on palloc for
+	 * memory allocation, so we could get NULL via HASH_ENTER_NULL when there is no
+	 * space in the shared memory. That's why we prefer continuing the execution
+	 * instead of throwing an error.
+	 */
+	connectionEntry =
+		hash_search(SharedConnStatsHash, connKey, HASH_ENTER_NULL, &entryFound);
+	if (!connectionEntry)
+	{
+		UnLockConnectionSharedMemory();
+		return NULL;
+	}
+
+	if (!entryFound)
+	{
+		/* we successfully allocated the entry for the first time, so initialize it */
+		pg_atomic_init_u32(&connectionEntry->connectionCount, 0);
+		pg_atomic_init_u32(&connectionEntry->waitingBackendCount, 0);
+
+		*entryCreated = true;
+	}
+
+	return connectionEntry;
+}
+
+
+/*
+ * RemoveSharedConnStatsEntryIfUnused removes the entry for the given key if
+ * there are neither connections to the node nor backends waiting for one.
+ *
+ * We don't have to remove at this point as the node might be still active
+ * and will have new connections open to it. Still, this keeps entries of
+ * removed or updated nodes from piling up in the hash, and given the default
+ * value of MaxCachedConnectionsPerWorker = 1, we're unlikely to trigger this
+ * often.
+ */
+static void
+RemoveSharedConnStatsEntryIfUnused(SharedConnStatsHashKey *connKey)
+{
+	bool entryFound = false;
+
+	LockConnectionSharedMemory(LW_EXCLUSIVE);
+
+	SharedConnStatsHashEntry *connectionEntry =
+		hash_search(SharedConnStatsHash, connKey, HASH_FIND, &entryFound);
+
+	/* the counters cannot change while we hold the exclusive lock */
+	if (entryFound &&
+		pg_atomic_read_u32(&connectionEntry->connectionCount) == 0 &&
+		pg_atomic_read_u32(&connectionEntry->waitingBackendCount) == 0)
+	{
+		hash_search(SharedConnStatsHash, connKey, HASH_REMOVE, &entryFound);
+	}
+
+	UnLockConnectionSharedMemory();
+}
+
+
+/*
+ * TryReserveSharedConnectionSlot atomically increments the connection counter
+ * of the given entry unless that would exceed connectionLimit. Returns true if
+ * the counter is incremented.
+ */
+static bool
+TryReserveSharedConnectionSlot(SharedConnStatsHashEntry *connectionEntry,
+							   int connectionLimit)
+{
+	uint32 currentCount = pg_atomic_read_u32(&connectionEntry->connectionCount);
+
+	while ((int64) currentCount + 1 <= connectionLimit)
+	{
+		/* on failure, currentCount is updated to the latest value */
+		if (pg_atomic_compare_exchange_u32(&connectionEntry->connectionCount,
+										   &currentCount, currentCount + 1))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * RegisterSharedConnectionWaiter increments the number of backends that wait
+ * for a connection slot for the given hostname/port and the current database
+ * in SharedConnStatsHash, and remembers the registration such that
+ * UnregisterSharedConnectionWaiter() can undo it.
+ */
+static void
+RegisterSharedConnectionWaiter(const char *hostname, int port)
+{
+	SharedConnStatsHashKey connKey;
+
+	Assert(!RegisteredAsConnectionWaiter);
+
+	if (MaxSharedPoolSize == DISABLE_CONNECTION_THROTTLING)
+	{
+		/* connection throttling disabled */
+		return;
+	}
+
+	InitializeSharedConnStatsKey(&connKey, hostname, port);
+
+	bool entryCreated = false;
+	SharedConnStatsHashEntry *connectionEntry =
+		LockAndFindSharedConnStatsEntry(&connKey, true, &entryCreated);
+
+	/* not being able to advertise that we wait only makes the wait longer */
+	if (!connectionEntry)
+	{
+		return;
+	}
+
+	pg_atomic_fetch_add_u32(&connectionEntry->waitingBackendCount, 1);
+
+	/* nothing can throw between incrementing the counter and setting the flag */
+	WaitingForConnectionKey = connKey;
+	RegisteredAsConnectionWaiter = true;
+
+	UnLockConnectionSharedMemory();
+}
+
+
+/*
+ * UnregisterSharedConnectionWaiter undoes RegisterSharedConnectionWaiter(), if
+ * the backend is registered as a waiter. Besides the regular exit from
+ * WaitLoopForSharedConnection(), it is called on errors and before shared
+ * memory exit, since a backend that is terminated while waiting would
+ * otherwise leave the waiter count incremented forever. That would make the
+ * other backends close their cached connections to the node at the end of
+ * every transaction.
+ *
+ * We do not check MaxSharedPoolSize here, as the registration has to be undone
+ * even if connection throttling was disabled in the meantime.
+ */
+void
+UnregisterSharedConnectionWaiter(void)
+{
+	if (!RegisteredAsConnectionWaiter)
+	{
+		return;
+	}
+
+	/* clear the flag first, such that we never undo the registration twice */
+	RegisteredAsConnectionWaiter = false;
+
+	bool entryCreated = false;
+	SharedConnStatsHashEntry *connectionEntry =
+		LockAndFindSharedConnStatsEntry(&WaitingForConnectionKey, false,
+										&entryCreated);
+
+	/* entries are not removed while there are waiters, but be defensive */
+	if (!connectionEntry)
+	{
+		return;
+	}
+
+	uint32 previousCount =
+		pg_atomic_fetch_sub_u32(&connectionEntry->waitingBackendCount, 1);
+
+	/* we should never go below 0 */
+	Assert(previousCount > 0);
+
+	bool entryUnused = previousCount == 1 &&
+					   pg_atomic_read_u32(&connectionEntry->connectionCount) == 0;
+
+	UnLockConnectionSharedMemory();
+
+	if (entryUnused)
+	{
+		RemoveSharedConnStatsEntryIfUnused(&WaitingForConnectionKey);
+	}
+}
+
+
+/*
+ * SharedConnectionWaiterCount returns the number of backends that wait for a
+ * connection slot for the given hostname/port and the current database.
+ */
+int
+SharedConnectionWaiterCount(const char *hostname, int port)
+{
+	SharedConnStatsHashKey connKey;
+
+	InitializeSharedConnStatsKey(&connKey, hostname, port);
+
+	bool entryCreated = false;
+	SharedConnStatsHashEntry *connectionEntry =
+		LockAndFindSharedConnStatsEntry(&connKey, false, &entryCreated);
+	if (!connectionEntry)
+	{
+		return 0;
+	}
+
+	int waitingBackendCount =
+		(int) pg_atomic_read_u32(&connectionEntry->waitingBackendCount);
+
+	UnLockConnectionSharedMemory();
+
+	return waitingBackendCount;
+}
+
+
+/*
+ * SharedConnectionHasWaiters returns true if there are backends waiting for a
+ * connection slot for the given hostname/port and the current database. A
+ * backend that holds an idle connection to the node should then close it at the
+ * end of the transaction instead of caching it, which lets connection slots move
+ * between backends instead of staying with whichever backend opened them.
+ */
+bool
+SharedConnectionHasWaiters(const char *hostname, int port)
+{
+	if (MaxSharedPoolSize == DISABLE_CONNECTION_THROTTLING)
+	{
+		/* connection throttling disabled, nobody waits */
+		return false;
+	}
+
+	return SharedConnectionWaiterCount(hostname, port) > 0;
+}
+
+
 /*
  * TryToIncrementSharedConnectionCounter tries to increment the shared
  * connection counter for the given nodeId and the current database in
@@ -287,13 +630,7 @@ TryToIncrementSharedConnectionCounter(const char *hostname, int port)
 	bool counterIncremented = false;
 	SharedConnStatsHashKey connKey;
 
-	strlcpy(connKey.hostname, hostname, MAX_NODE_LENGTH);
-	if (strlen(hostname) > MAX_NODE_LENGTH)
-	{
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-						errmsg("hostname exceeds the maximum length of %d",
-							   MAX_NODE_LENGTH)));
-	}
+	InitializeSharedConnStatsKey(&connKey, hostname, port);
 
 	/*
 	 * The local session might already have some reserved connections to the given
@@ -307,9 +644,6 @@ TryToIncrementSharedConnectionCounter(const char *hostname, int port)
 		return true;
 	}
 
-	connKey.port = port;
-	connKey.databaseOid = MyDatabaseId;
-
 	/*
 	 * Handle adaptive connection management for the local node slightly different
 	 * as local node can failover to local execution.
@@ -336,17 +670,9 @@ TryToIncrementSharedConnectionCounter(const char *hostname, int port)
 		activeBackendCount = GetExternalClientBackendCount();
 	}
 
-	LockConnectionSharedMemory(LW_EXCLUSIVE);
-
-	/*
-	 * As the hash map is allocated in shared memory, it doesn't rely on palloc for
-	 * memory allocation, so we could get NULL via HASH_ENTER_NULL when there is no
-	 * space in the shared memory. That's why we prefer continuing the execution
-	 * instead of throwing an error.
-	 */
-	bool entryFound = false;
+	bool entryCreated = false;
 	SharedConnStatsHashEntry *connectionEntry =
-		hash_search(SharedConnStatsHash, &connKey, HASH_ENTER_NULL, &entryFound);
+		LockAndFindSharedConnStatsEntry(&connKey, true, &entryCreated);
 
 	/*
 	 * It is possible to throw an error at this point, but that doesn't help us in anyway.
@@ -355,14 +681,13 @@ TryToIncrementSharedConnectionCounter(const char *hostname, int port)
 	 */
 	if (!connectionEntry)
 	{
-		UnLockConnectionSharedMemory();
 		return true;
 	}
 
-	if (!entryFound)
+	if (entryCreated)
 	{
-		/* we successfully allocated the entry for the first time, so initialize it */
-		connectionEntry->connectionCount = 1;
+		/* the first connection to a node is always allowed */
+		pg_atomic_fetch_add_u32(&connectionEntry->connectionCount, 1);
 
 		counterIncremented = true;
 	}
@@ -384,25 +709,18 @@ TryToIncrementSharedConnectionCounter(const char *hostname, int port)
 		{
 			counterIncremented = false;
 		}
-		else if (connectionEntry->connectionCount + 1 > GetLocalSharedPoolSize())
-		{
-			counterIncremented = false;
-		}
 		else
 		{
-			connectionEntry->connectionCount++;
-			counterIncremented = true;
+			counterIncremented =
+				TryReserveSharedConnectionSlot(connectionEntry,
+											   GetLocalSharedPoolSize());
 		}
 	}
-	else if (connectionEntry->connectionCount + 1 > GetMaxSharedPoolSize())
-	{
-		/* there is no space left for this connection */
-		counterIncremented = false;
-	}
 	else
 	{
-		connectionEntry->connectionCount++;
-		counterIncremented = true;
+		/* fails if there is no space left for this connection */
+		counterIncremented =
+			TryReserveSharedConnectionSlot(connectionEntry, GetMaxSharedPoolSize());
 	}
 
 	UnLockConnectionSharedMemory();
@@ -426,27 +744,11 @@ IncrementSharedConnectionCounter(const char *hostname, int port)
 		return;
 	}
 
-	strlcpy(connKey.hostname, hostname, MAX_NODE_LENGTH);
-	if (strlen(hostname) > MAX_NODE_LENGTH)
-	{
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-						errmsg("hostname exceeds the maximum length of %d",
-							   MAX_NODE_LENGTH)));
-	}
-
-	connKey.port = port;
-	connKey.databaseOid = MyDatabaseId;
-
-	LockConnectionSharedMemory(LW_EXCLUSIVE);
+	InitializeSharedConnStatsKey(&connKey, hostname, port);
 
-	/*
-	 * As the hash map is allocated in shared memory, it doesn't rely on palloc for
-	 * memory allocation, so we could get NULL via HASH_ENTER_NULL. That's why we prefer
-	 * continuing the execution instead of throwing an error.
-	 */
-	bool entryFound = false;
+	bool entryCreated = false;
 	SharedConnStatsHashEntry *connectionEntry =
-		hash_search(SharedConnStatsHash, &connKey, HASH_ENTER_NULL, &entryFound);
+		LockAndFindSharedConnStatsEntry(&connKey, true, &entryCreated);
 
 	/*
 	 * It is possible to throw an error at this point, but that doesn't help us in anyway.
@@ -455,21 +757,13 @@ IncrementSharedConnectionCounter(const char *hostname, int port)
 	 */
 	if (!connectionEntry)
 	{
-		UnLockConnectionSharedMemory();
-
 		ereport(DEBUG4, (errmsg("No entry found for node %s:%d while incrementing "
 								"connection counter", hostname, port)));
 
 		return;
 	}
 
-	if (!entryFound)
-	{
-		/* we successfully allocated the entry for the first time, so initialize it */
-		connectionEntry->connectionCount = 0;
-	}
-
-	connectionEntry->connectionCount += 1;
+	pg_atomic_fetch_add_u32(&connectionEntry->connectionCount, 1);
 
 	UnLockConnectionSharedMemory();
 }
@@ -494,28 +788,15 @@ DecrementSharedConnectionCounter(const char *hostname, int port)
 		return;
 	}
 
-	strlcpy(connKey.hostname, hostname, MAX_NODE_LENGTH);
-	if (strlen(hostname) > MAX_NODE_LENGTH)
-	{
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-						errmsg("hostname exceeds the maximum length of %d",
-							   MAX_NODE_LENGTH)));
-	}
-
-	connKey.port = port;
-	connKey.databaseOid = MyDatabaseId;
-
-	LockConnectionSharedMemory(LW_EXCLUSIVE);
+	InitializeSharedConnStatsKey(&connKey, hostname, port);
 
-	bool entryFound = false;
+	bool entryCreated = false;
 	SharedConnStatsHashEntry *connectionEntry =
-		hash_search(SharedConnStatsHash, &connKey, HASH_FIND, &entryFound);
+		LockAndFindSharedConnStatsEntry(&connKey, false, &entryCreated);
 
 	/* this worker node is removed or updated, no need to care */
-	if (!entryFound)
+	if (!connectionEntry)
 	{
-		UnLockConnectionSharedMemory();
-
 		/* wake up any waiters in case any backend is waiting for this node */
 		WakeupWaiterBackendsForSharedConnection();
 
@@ -525,26 +806,32 @@ DecrementSharedConnectionCounter(const char *hostname, int port)
 		return;
 	}
 
+	uint32 previousCount = pg_atomic_fetch_sub_u32(&connectionEntry->connectionCount, 1);
+
 	/* we should never go below 0 */
-	Assert(connectionEntry->connectionCount > 0);
+	Assert(previousCount > 0);
+
+	/*
+	 * Waiters register themselves before they re-check the connection counter,
+	 * and both the decrement above and the registration are full barriers. So,
+	 * either we see the waiter here, or the waiter sees the slot we released.
+	 * That lets us skip waking up all the waiting backends when nobody waits
+	 * for this node, which is the common case.
+	 */
+	uint32 waitingBackendCount =
+		pg_atomic_read_u32(&connectionEntry->waitingBackendCount);
 
-	connectionEntry->connectionCount -= 1;
+	UnLockConnectionSharedMemory();
 
-	if (connectionEntry->connectionCount == 0)
+	if (previousCount == 1 && waitingBackendCount == 0)
 	{
-		/*
-		 * We don't have to remove at this point as the node might be still active
-		 * and will have new connections open to it. Still, this seems like a convenient
-		 * place to remove the entry, as connectionCount == 0 implies that the server is
-		 * not busy, and given the default value of MaxCachedConnectionsPerWorker = 1,
-		 * we're unlikely to trigger this often.
-		 */
-		hash_search(SharedConnStatsHash, &connKey, HASH_REMOVE, &entryFound);
+		RemoveSharedConnStatsEntryIfUnused(&connKey);
 	}
 
-	UnLockConnectionSharedMemory();
-
-	WakeupWaiterBackendsForSharedConnection();
+	if (waitingBackendCount > 0)
+	{
+		WakeupWaiterBackendsForSharedConnection();
+	}
 }
 
 
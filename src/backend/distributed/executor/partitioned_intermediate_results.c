@@ -26,6 +26,7 @@
 #include "distributed/multi_executor.h"
 #include "distributed/pg_dist_shard.h"
 #include "distributed/remote_commands.h"
+#include "distributed/shardinterval_utils.h"
 #include "distributed/tuplestore.h"
 #include "distributed/utils/array_type.h"
 #include "distributed/utils/function.h"
@@ -84,6 +85,9 @@ typedef struct PartitionedResultDestReceiver
 	/* used for deciding which partition a shard belongs to. */
 	CitusTableCacheEntry *shardSearchInfo;
 
+	/* routes partition column values using shardSearchInfo */
+	ShardRoutingInfo *shardRoutingInfo;
+
 	/* Tuples matching shardSearchInfo[i] are sent to partitionDestReceivers[i]. */
 	DestReceiver **partitionDestReceivers;
 
@@ -418,6 +422,7 @@ CreatePartitionedResultDestReceiver(int partitionColumnIndex,
 	resultDest->partitionColumnIndex = partitionColumnIndex;
 	resultDest->partitionCount = partitionCount;
 	resultDest->shardSearchInfo = shardSearchInfo;
+	resultDest->shardRoutingInfo = CreateShardRoutingInfo(shardSearchInfo);
 	resultDest->partitionDestReceivers = partitionedDestReceivers;
 	resultDest->startedDestReceivers = NULL;
 	resultDest->lazyStartup = lazyStartup;
@@ -493,15 +498,17 @@ PartitionedResultDestReceiverReceive(TupleTableSlot *slot, DestReceiver *dest)
 	else
 	{
 		Datum partitionColumnValue = columnValues[self->partitionColumnIndex];
-		ShardInterval *shardInterval = FindShardInterval(partitionColumnValue,
-														 self->shardSearchInfo);
-		if (shardInterval == NULL)
+		int shardIndex = RouteDistributionValue(self->shardRoutingInfo,
+												partitionColumnValue);
+		if (shardIndex == INVALID_SHARD_INDEX)
 		{
 			ereport(ERROR, (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 							errmsg("could not find shard for partition column "
 								   "value")));
 		}
 
+		ShardInterval *shardInterval =
+			self->shardSearchInfo->sortedShardIntervalArray[shardIndex];
 		partitionIndex = shardInterval->shardIndex;
 	}
 
@@ -56,6 +56,7 @@
 #include "distributed/pg_dist_shard.h"
 #include "distributed/pg_dist_placement.h"
 #include "distributed/shared_library_init.h"
+#include "distributed/shard_pruning_cache.h"
 #include "distributed/shardinterval_utils.h"
 #include "distributed/utils/array_type.h"
 #include "distributed/utils/function.h"
@@ -95,6 +96,14 @@
 /* user configuration */
 int ReadFromSecondaries = USE_SECONDARY_NODES_NEVER;
 
+/*
+ * Placements of tables with at least this many shards are looked up using a
+ * single range scan over pg_dist_placement, as long as the shard ids of the table
+ * are not spread out over a range that is more than a few times the shard count.
+ */
+#define PLACEMENT_RANGE_SCAN_MIN_SHARD_COUNT 16
+#define PLACEMENT_RANGE_SCAN_MAX_SHARD_ID_SPREAD 4
+
 
 /*
  * CitusTableCacheEntrySlot is entry type for DistTableCacheHash,
@@ -281,6 +290,12 @@ static HeapTuple PgDistPartitionTupleViaCatalog(Oid relationId);
 static ShardIdCacheEntry * LookupShardIdCacheEntry(int64 shardId, bool missingOk);
 static CitusTableCacheEntry * BuildCitusTableCacheEntry(Oid relationId);
 static void BuildCachedShardList(CitusTableCacheEntry *cacheEntry);
+static GroupShardPlacement ** BuildPlacementArrayForShards(
+	ShardInterval **shardIntervalArray, int shardIntervalArrayLength,
+	int *placementCount);
+static List * PlacementListFromSortedArray(uint64 shardId,
+										   GroupShardPlacement **placementArray,
+										   int placementCount);
 static void PrepareWorkerNodeCache(void);
 static bool CheckInstalledVersion(int elevel);
 static char * AvailableExtensionVersion(void);
@@ -1995,6 +2010,17 @@ BuildCachedShardList(CitusTableCacheEntry *cacheEntry)
 	cacheEntry->sortedShardIntervalArray = sortedShardIntervalArray;
 	cacheEntry->shardIntervalArrayLength = 0;
 
+	/*
+	 * Tables with many shards would otherwise need an index scan on
+	 * pg_dist_placement per shard, which dominates the time it takes to build
+	 * the cache entry. Fetch the placements of all shards at once if possible.
+	 */
+	int rangePlacementCount = 0;
+	GroupShardPlacement **rangePlacementArray =
+		BuildPlacementArrayForShards(sortedShardIntervalArray,
+									 shardIntervalArrayLength,
+									 &rangePlacementCount);
+
 	/* maintain shardId->(table,ShardInterval) cache */
 	for (int shardIndex = 0; shardIndex < shardIntervalArrayLength; shardIndex++)
 	{
@@ -2020,7 +2046,16 @@ BuildCachedShardList(CitusTableCacheEntry *cacheEntry)
 		cacheEntry->shardIntervalArrayLength++;
 
 		/* build list of shard placements */
-		List *placementList = BuildShardPlacementList(shardId);
+		List *placementList = NIL;
+		if (rangePlacementArray != NULL)
+		{
+			placementList = PlacementListFromSortedArray(shardId, rangePlacementArray,
+														 rangePlacementCount);
+		}
+		else
+		{
+			placementList = BuildShardPlacementList(shardId);
+		}
 		int numberOfPlacements = list_length(placementList);
 
 		/* and copy that list into the cache entry */
@@ -2047,6 +2082,121 @@ BuildCachedShardList(CitusTableCacheEntry *cacheEntry)
 }
 
 
+/*
+ * BuildPlacementArrayForShards fetches the placements of all the given shards
+ * with a single range scan over the shard ids and returns them in an array that
+ * is sorted by shard id, with the placements of each shard in the same order as
+ * BuildShardPlacementList returns them. If there are too few shards for this to
+ * pay off, or the shard ids are so far apart that the scan would mostly return
+ * placements of other tables, the function returns NULL and placements should be
+ * looked up per shard instead.
+ */
+static GroupShardPlacement **
+BuildPlacementArrayForShards(ShardInterval **shardIntervalArray,
+							 int shardIntervalArrayLength, int *placementCount)
+{
+	*placementCount = 0;
+
+	if (shardIntervalArrayLength < PLACEMENT_RANGE_SCAN_MIN_SHARD_COUNT)
+	{
+		return NULL;
+	}
+
+	uint64 minShardId = PG_UINT64_MAX;
+	uint64 maxShardId = 0;
+	for (int shardIndex = 0; shardIndex < shardIntervalArrayLength; shardIndex++)
+	{
+		uint64 shardId = shardIntervalArray[shardIndex]->shardId;
+
+		minShardId = Min(minShardId, shardId);
+		maxShardId = Max(maxShardId, shardId);
+	}
+
+	uint64 shardIdSpread = maxShardId - minShardId + 1;
+	if (shardIdSpread / PLACEMENT_RANGE_SCAN_MAX_SHARD_ID_SPREAD >
+		(uint64) shardIntervalArrayLength)
+	{
+		return NULL;
+	}
+
+	List *placementList = BuildShardPlacementListForShardIdRange(minShardId,
+																 maxShardId);
+	int placementListLength = list_length(placementList);
+	GroupShardPlacement **placementArray =
+		palloc0(Max(placementListLength, 1) * sizeof(GroupShardPlacement *));
+
+	int placementIndex = 0;
+	GroupShardPlacement *placement = NULL;
+	foreach_ptr(placement, placementList)
+	{
+		placementArray[placementIndex++] = placement;
+	}
+
+	/*
+	 * The index scan returns placements in the same order as the per-shard
+	 * lookups in BuildShardPlacementList, and placement order affects which
+	 * placements tasks are assigned to. Hence we do not sort the placements
+	 * ourselves. If the catalog was scanned without the index, the placements
+	 * are not ordered by shard id and we fall back to per-shard lookups.
+	 */
+	for (placementIndex = 1; placementIndex < placementListLength; placementIndex++)
+	{
+		if (placementArray[placementIndex - 1]->shardId >
+			placementArray[placementIndex]->shardId)
+		{
+			return NULL;
+		}
+	}
+
+	*placementCount = placementListLength;
+
+	return placementArray;
+}
+
+
+/*
+ * PlacementListFromSortedArray returns a list of the placements of the given
+ * shard in an array of placements sorted by shard id.
+ */
+static List *
+PlacementListFromSortedArray(uint64 shardId, GroupShardPlacement **placementArray,
+							 int placementCount)
+{
+	List *placementList = NIL;
+	int lowerBoundIndex = 0;
+	int upperBoundIndex = placementCount;
+
+	/* find the first placement with a shard id that is not smaller than shardId */
+	while (lowerBoundIndex < upperBoundIndex)
+	{
+		int middleIndex = lowerBoundIndex + ((upperBoundIndex - lowerBoundIndex) / 2);
+
+		if (placementArray[middleIndex]->shardId < shardId)
+		{
+			lowerBoundIndex = middleIndex + 1;
+		}
+		else
+		{
+			upperBoundIndex = middleIndex;
+		}
+	}
+
+	for (int placementIndex = lowerBoundIndex; placementIndex < placementCount;
+		 placementIndex++)
+	{
+		GroupShardPlacement *placement = placementArray[placementIndex];
+		if (placement->shardId != shardId)
+		{
+			break;
+		}
+
+		placementList = lappend(placementList, placement);
+	}
+
+	return placementList;
+}
+
+
 /*
  * ErrorIfInconsistentShardIntervals checks if shard intervals are consistent with
  * our expectations.
@@ -4766,6 +4916,7 @@ InvalidateDistRelationCacheCallback(Datum argument, Oid relationId)
 		InvalidateDistTableCache();
 		InvalidateDistObjectCache();
 		InvalidateMetadataSystemCache();
+		InvalidateShardPruningCache(InvalidOid);
 	}
 	else
 	{
@@ -4782,6 +4933,7 @@ InvalidateDistRelationCacheCallback(Datum argument, Oid relationId)
 		if (foundInCache)
 		{
 			InvalidateCitusTableCacheEntrySlot(cacheSlot);
+			InvalidateShardPruningCache(relationId);
 		}
 
 		/*
@@ -5043,6 +5195,9 @@ InvalidateNodeRelationCacheCallback(Datum argument, Oid relationId)
 	{
 		workerNodeHashValid = false;
 		LocalNodeId = -1;
+
+		/* active placements depend on the state of the nodes */
+		InvalidateShardPruningCache(InvalidOid);
 	}
 }
 
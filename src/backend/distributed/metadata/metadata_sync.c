@@ -90,6 +90,30 @@
 #include "utils/syscache.h"
 
 
+/*
+ * While activating nodes, metadata sync commands that are generated per catalog
+ * row are sent in batches of roughly this many bytes, such that we do not pay a
+ * round trip per table, object or colocation group.
+ */
+#define METADATA_SYNC_COMMAND_BATCH_SIZE (1024 * 1024)
+
+
+/*
+ * MetadataSyncCommandBatch accumulates metadata sync commands until they are
+ * sent to the activated nodes in a single round trip.
+ */
+typedef struct MetadataSyncCommandBatch
+{
+	MetadataSyncContext *syncContext;
+
+	/* holds the batched commands, as the sync context is reset for each row */
+	MemoryContext batchContext;
+
+	List *commandList;
+	Size commandListSize;
+} MetadataSyncCommandBatch;
+
+
 /* managed via a GUC */
 char *EnableManualMetadataChangesForUser = "";
 int MetadataSyncTransMode = METADATA_SYNC_TRANSACTIONAL;
@@ -151,6 +175,12 @@ static char * RemoteSchemaIdExpressionByName(char *schemaName);
 static char * RemoteTypeIdExpression(Oid typeId);
 static char * RemoteCollationIdExpression(Oid colocationId);
 static char * RemoteTableIdExpression(Oid relationId);
+static MetadataSyncCommandBatch * CreateMetadataSyncCommandBatch(
+	MetadataSyncContext *context);
+static void AddCommandListToMetadataSyncBatch(MetadataSyncCommandBatch *batch,
+											  List *commandList);
+static void FlushMetadataSyncCommandBatch(MetadataSyncCommandBatch *batch);
+static void FinishMetadataSyncCommandBatch(MetadataSyncCommandBatch *batch);
 
 
 PG_FUNCTION_INFO_V1(start_metadata_sync_to_all_nodes);
@@ -4366,6 +4396,95 @@ SendOrCollectCommandListToActivatedNodes(MetadataSyncContext *context, List *com
 }
 
 
+/*
+ * CreateMetadataSyncCommandBatch creates an empty batch of commands to be sent
+ * to the activated nodes of the given metadata sync context.
+ */
+static MetadataSyncCommandBatch *
+CreateMetadataSyncCommandBatch(MetadataSyncContext *context)
+{
+	MetadataSyncCommandBatch *batch = palloc0(sizeof(MetadataSyncCommandBatch));
+
+	batch->syncContext = context;
+	batch->batchContext = AllocSetContextCreate(TopTransactionContext,
+												"metadata sync command batch",
+												ALLOCSET_DEFAULT_SIZES);
+	batch->commandList = NIL;
+	batch->commandListSize = 0;
+
+	return batch;
+}
+
+
+/*
+ * AddCommandListToMetadataSyncBatch adds the given commands to the batch, and
+ * sends the batch to the activated nodes once it grows beyond
+ * METADATA_SYNC_COMMAND_BATCH_SIZE.
+ *
+ * When the sync context only collects commands, there is no round trip to save
+ * and the commands are collected right away.
+ */
+static void
+AddCommandListToMetadataSyncBatch(MetadataSyncCommandBatch *batch, List *commandList)
+{
+	if (MetadataSyncCollectsCommands(batch->syncContext))
+	{
+		SendOrCollectCommandListToActivatedNodes(batch->syncContext, commandList);
+		return;
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(batch->batchContext);
+
+	char *command = NULL;
+	foreach_ptr(command, commandList)
+	{
+		batch->commandList = lappend(batch->commandList, pstrdup(command));
+		batch->commandListSize += strlen(command);
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	if (batch->commandListSize >= METADATA_SYNC_COMMAND_BATCH_SIZE)
+	{
+		FlushMetadataSyncCommandBatch(batch);
+	}
+}
+
+
+/*
+ * FlushMetadataSyncCommandBatch sends the batched commands, if any, to the
+ * activated nodes and empties the batch.
+ */
+static void
+FlushMetadataSyncCommandBatch(MetadataSyncCommandBatch *batch)
+{
+	if (batch->commandList == NIL)
+	{
+		return;
+	}
+
+	SendOrCollectCommandListToActivatedNodes(batch->syncContext, batch->commandList);
+
+	MemoryContextReset(batch->batchContext);
+	batch->commandList = NIL;
+	batch->commandListSize = 0;
+}
+
+
+/*
+ * FinishMetadataSyncCommandBatch sends the remaining commands in the batch and
+ * releases its memory.
+ */
+static void
+FinishMetadataSyncCommandBatch(MetadataSyncCommandBatch *batch)
+{
+	FlushMetadataSyncCommandBatch(batch);
+
+	MemoryContextDelete(batch->batchContext);
+	pfree(batch);
+}
+
+
 /*
  * SendOrCollectCommandListToMetadataNodes sends the commands to the metadata nodes with
  * bare connections inside metadatacontext or via coordinated connections.
@@ -4670,6 +4789,8 @@ SendColocationMetadataCommands(MetadataSyncContext *context)
 	SysScanDesc scanDesc = systable_beginscan(relation, InvalidOid, false, NULL,
 											  scanKeyCount, scanKey);
 
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	MemoryContext oldContext = MemoryContextSwitchTo(context->context);
 	HeapTuple nextTuple = NULL;
 	while (true)
@@ -4743,10 +4864,12 @@ SendColocationMetadataCommands(MetadataSyncContext *context)
 						 " = c.collnamespace)");
 
 		List *commandList = list_make1(colocationGroupCreateCommand->data);
-		SendOrCollectCommandListToActivatedNodes(context, commandList);
+		AddCommandListToMetadataSyncBatch(batch, commandList);
 	}
 	MemoryContextSwitchTo(oldContext);
 
+	FinishMetadataSyncCommandBatch(batch);
+
 	systable_endscan(scanDesc);
 	table_close(relation, AccessShareLock);
 }
@@ -4768,6 +4891,8 @@ SendTenantSchemaMetadataCommands(MetadataSyncContext *context)
 	SysScanDesc scanDesc = systable_beginscan(pgDistTenantSchema, InvalidOid, false, NULL,
 											  scanKeyCount, scanKey);
 
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	MemoryContext oldContext = MemoryContextSwitchTo(context->context);
 	HeapTuple heapTuple = NULL;
 	while (true)
@@ -4790,10 +4915,12 @@ SendTenantSchemaMetadataCommands(MetadataSyncContext *context)
 						 tenantSchemaForm->colocationid);
 
 		List *commandList = list_make1(insertTenantSchemaCommand->data);
-		SendOrCollectCommandListToActivatedNodes(context, commandList);
+		AddCommandListToMetadataSyncBatch(batch, commandList);
 	}
 	MemoryContextSwitchTo(oldContext);
 
+	FinishMetadataSyncCommandBatch(batch);
+
 	systable_endscan(scanDesc);
 	table_close(pgDistTenantSchema, AccessShareLock);
 }
@@ -4807,9 +4934,10 @@ SendTenantSchemaMetadataCommands(MetadataSyncContext *context)
 void
 SendDependencyCreationCommands(MetadataSyncContext *context)
 {
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	/* disable ddl propagation */
-	SendOrCollectCommandListToActivatedNodes(context,
-											 list_make1(DISABLE_DDL_PROPAGATION));
+	AddCommandListToMetadataSyncBatch(batch, list_make1(DISABLE_DDL_PROPAGATION));
 
 	MemoryContext oldContext = MemoryContextSwitchTo(context->context);
 
@@ -4853,18 +4981,20 @@ SendDependencyCreationCommands(MetadataSyncContext *context)
 
 		/* dependency creation commands */
 		List *ddlCommands = GetAllDependencyCreateDDLCommands(list_make1(dependency));
-		SendOrCollectCommandListToActivatedNodes(context, ddlCommands);
+		AddCommandListToMetadataSyncBatch(batch, ddlCommands);
 	}
 	MemoryContextSwitchTo(oldContext);
 
+	/* enable ddl propagation */
+	AddCommandListToMetadataSyncBatch(batch, list_make1(ENABLE_DDL_PROPAGATION));
+
+	FinishMetadataSyncCommandBatch(batch);
+
 	if (!MetadataSyncCollectsCommands(context))
 	{
 		MemoryContextDelete(commandsContext);
 	}
 	ResetMetadataSyncMemoryContext(context);
-
-	/* enable ddl propagation */
-	SendOrCollectCommandListToActivatedNodes(context, list_make1(ENABLE_DDL_PROPAGATION));
 }
 
 
@@ -4885,6 +5015,8 @@ SendDistTableMetadataCommands(MetadataSyncContext *context)
 	SysScanDesc scanDesc = systable_beginscan(relation, InvalidOid, false, NULL,
 											  scanKeyCount, scanKey);
 
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	MemoryContext oldContext = MemoryContextSwitchTo(context->context);
 	HeapTuple nextTuple = NULL;
 	while (true)
@@ -4908,10 +5040,12 @@ SendDistTableMetadataCommands(MetadataSyncContext *context)
 		}
 
 		List *commandList = CitusTableMetadataCreateCommandList(relationId);
-		SendOrCollectCommandListToActivatedNodes(context, commandList);
+		AddCommandListToMetadataSyncBatch(batch, commandList);
 	}
 	MemoryContextSwitchTo(oldContext);
 
+	FinishMetadataSyncCommandBatch(batch);
+
 	systable_endscan(scanDesc);
 	table_close(relation, AccessShareLock);
 }
@@ -4934,6 +5068,8 @@ SendDistObjectCommands(MetadataSyncContext *context)
 	SysScanDesc scanDesc = systable_beginscan(relation, InvalidOid, false, NULL,
 											  scanKeyCount, scanKey);
 
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	MemoryContext oldContext = MemoryContextSwitchTo(context->context);
 	HeapTuple nextTuple = NULL;
 	while (true)
@@ -4997,11 +5133,13 @@ SendDistObjectCommands(MetadataSyncContext *context)
 												list_make1_int(distributionArgumentIndex),
 												list_make1_int(colocationId),
 												list_make1_int(forceDelegation));
-		SendOrCollectCommandListToActivatedNodes(context,
-												 list_make1(workerMetadataUpdateCommand));
+		AddCommandListToMetadataSyncBatch(batch,
+										  list_make1(workerMetadataUpdateCommand));
 	}
 	MemoryContextSwitchTo(oldContext);
 
+	FinishMetadataSyncCommandBatch(batch);
+
 	systable_endscan(scanDesc);
 	relation_close(relation, NoLock);
 }
@@ -5016,9 +5154,10 @@ SendDistObjectCommands(MetadataSyncContext *context)
 void
 SendInterTableRelationshipCommands(MetadataSyncContext *context)
 {
+	MetadataSyncCommandBatch *batch = CreateMetadataSyncCommandBatch(context);
+
 	/* disable ddl propagation */
-	SendOrCollectCommandListToActivatedNodes(context,
-											 list_make1(DISABLE_DDL_PROPAGATION));
+	AddCommandListToMetadataSyncBatch(batch, list_make1(DISABLE_DDL_PROPAGATION));
 
 	ScanKeyData scanKey[1];
 	int scanKeyCount = 0;
@@ -5057,7 +5196,7 @@ SendInterTableRelationshipCommands(MetadataSyncContext *context)
 		}
 
 		List *commandList = InterTableRelationshipOfRelationCommandList(relationId);
-		SendOrCollectCommandListToActivatedNodes(context, commandList);
+		AddCommandListToMetadataSyncBatch(batch, commandList);
 	}
 	MemoryContextSwitchTo(oldContext);
 
@@ -5065,5 +5204,7 @@ SendInterTableRelationshipCommands(MetadataSyncContext *context)
 	table_close(relation, AccessShareLock);
 
 	/* enable ddl propagation */
-	SendOrCollectCommandListToActivatedNodes(context, list_make1(ENABLE_DDL_PROPAGATION));
+	AddCommandListToMetadataSyncBatch(batch, list_make1(ENABLE_DDL_PROPAGATION));
+
+	FinishMetadataSyncCommandBatch(batch);
 }
@@ -1621,6 +1621,54 @@ BuildShardPlacementList(int64 shardId)
 }
 
 
+/*
+ * BuildShardPlacementListForShardIdRange finds shard placements for all shards
+ * with an id between minShardId and maxShardId (inclusive) using a single index
+ * scan, and returns their in-memory representations in a new list. This is used
+ * when building the metadata cache for a table with many shards, since doing a
+ * separate catalog lookup per shard gets expensive. When the shardid index is
+ * used, the list is in index order, which matches the order of the placements
+ * returned by BuildShardPlacementList for each shard.
+ */
+List *
+BuildShardPlacementListForShardIdRange(int64 minShardId, int64 maxShardId)
+{
+	List *shardPlacementList = NIL;
+	ScanKeyData scanKey[2];
+	int scanKeyCount = 2;
+	bool indexOK = true;
+
+	Relation pgPlacement = table_open(DistPlacementRelationId(), AccessShareLock);
+	TupleDesc tupleDescriptor = RelationGetDescr(pgPlacement);
+
+	ScanKeyInit(&scanKey[0], Anum_pg_dist_placement_shardid,
+				BTGreaterEqualStrategyNumber, F_INT8GE, Int64GetDatum(minShardId));
+	ScanKeyInit(&scanKey[1], Anum_pg_dist_placement_shardid,
+				BTLessEqualStrategyNumber, F_INT8LE, Int64GetDatum(maxShardId));
+
+	SysScanDesc scanDescriptor = systable_beginscan(pgPlacement,
+													DistPlacementShardidIndexId(),
+													indexOK,
+													NULL, scanKeyCount, scanKey);
+
+	HeapTuple heapTuple = systable_getnext(scanDescriptor);
+	while (HeapTupleIsValid(heapTuple))
+	{
+		GroupShardPlacement *placement =
+			TupleToGroupShardPlacement(tupleDescriptor, heapTuple);
+
+		shardPlacementList = lappend(shardPlacementList, placement);
+
+		heapTuple = systable_getnext(scanDescriptor);
+	}
+
+	systable_endscan(scanDescriptor);
+	table_close(pgPlacement, NoLock);
+
+	return shardPlacementList;
+}
+
+
 /*
  * BuildShardPlacementListForGroup finds shard placements for the given groupId
  * from system catalogs, converts these placements to their in-memory
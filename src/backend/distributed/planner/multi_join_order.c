@@ -41,6 +41,7 @@
 /* Config variables managed via guc.c */
 bool LogMultiJoinOrder = false; /* print join order as a debugging aid */
 bool EnableSingleHashRepartitioning = false;
+bool EnableNestedShardRangeJoins = false;
 
 /* Function pointer type definition for join rule evaluation functions */
 typedef JoinOrderNode *(*RuleEvalFunction) (JoinOrderNode *currentJoinNode,
@@ -932,13 +933,27 @@ LocalJoin(JoinOrderNode *currentJoinNode, TableEntry *candidateTable,
 		return NULL;
 	}
 
-	/* shard interval lists must have 1-1 matching for local joins */
+	/*
+	 * Shard interval lists must have 1-1 matching for local joins, unless each
+	 * anchor shard falls within a single shard of the candidate table. In the
+	 * latter case, each task joins an anchor shard with its covering candidate
+	 * shard, which only preserves the semantics if the candidate table is on the
+	 * inner side of the join.
+	 */
 	bool coPartitionedTables = CoPartitionedTables(currentAnchorTable->relationId,
 												   relationId);
 
 	if (!coPartitionedTables)
 	{
-		return NULL;
+		bool candidateOnInnerSide = (joinType == JOIN_INNER ||
+									 joinType == JOIN_LEFT ||
+									 joinType == JOIN_ANTI);
+
+		if (!EnableNestedShardRangeJoins || !candidateOnInnerSide ||
+			!NestedShardRangeTables(currentAnchorTable->relationId, relationId))
+		{
+			return NULL;
+		}
 	}
 
 	/*
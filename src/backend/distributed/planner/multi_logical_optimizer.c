@@ -165,6 +165,15 @@ typedef struct OrderByLimitReference
 	bool hasOrderByAggregate;
 	bool canApproximate;
 	bool hasDistinctOn;
+
+	/*
+	 * Number of leading sort clauses that cover all group by clauses before
+	 * any aggregate is used in the sort clauses, 0 if there is no such prefix.
+	 */
+	int groupCoveringSortPrefixLength;
+
+	/* query is ordered by max() DESC or min() ASC, followed by group columns */
+	bool orderByMinMaxAggregate;
 } OrderByLimitReference;
 
 
@@ -318,6 +327,10 @@ static List * WorkerSortClauseList(Node *limitCount,
 								   OrderByLimitReference orderByLimitReference);
 static bool CanPushDownLimitApproximate(List *sortClauseList, List *targetList);
 static bool HasOrderByAggregate(List *sortClauseList, List *targetList);
+static int GroupCoveringSortPrefixLength(List *sortClauseList, List *groupClauseList,
+										 List *targetList);
+static bool OrderByMinMaxAggregate(List *sortClauseList, List *groupClauseList,
+								   List *targetList);
 static bool HasOrderByNonCommutativeAggregate(List *sortClauseList, List *targetList);
 static bool HasOrderByComplexExpression(List *sortClauseList, List *targetList);
 static bool HasOrderByHllType(List *sortClauseList, List *targetList);
@@ -2808,6 +2821,10 @@ BuildOrderByLimitReference(bool hasDistinctOn, bool groupedByDisjointPartitionCo
 		CanPushDownLimitApproximate(sortClauseList, targetList);
 	limitOrderByReference.hasOrderByAggregate =
 		HasOrderByAggregate(sortClauseList, targetList);
+	limitOrderByReference.groupCoveringSortPrefixLength =
+		GroupCoveringSortPrefixLength(sortClauseList, groupClause, targetList);
+	limitOrderByReference.orderByMinMaxAggregate =
+		OrderByMinMaxAggregate(sortClauseList, groupClause, targetList);
 
 	return limitOrderByReference;
 }
@@ -4660,9 +4677,19 @@ ExtractQueryWalker(Node *node, List **queryList)
  *                       1/           \0
  *           has order by agg?          (no pd)
  *            1/           \0
- *     can approximate?    (exact pd)
- *      1/       \0
- * (approx pd)   (no pd)
+ *   exact top-n order by?  (exact pd)
+ *        1/       \0
+ *  (exact pd)   can approximate?
+ *                1/       \0
+ *           (approx pd)   (no pd)
+ *
+ * The order by allows an exact top-n pushdown when either the leading sort
+ * clauses cover all group by clauses, or the query is ordered by max() DESC
+ * NULLS LAST or min() ASC NULLS LAST (optionally followed by group columns).
+ * In both cases, each of the resulting groups is among the first N groups of
+ * at least one shard, with its final ordering value computed from that shard.
+ *
+ * When approximating, we fetch at least as many rows as the limit itself.
  *
  * When an offset is present, the offset value is added to limit because for a query
  * with LIMIT x OFFSET y, (x+y) records should be pulled from the workers.
@@ -4726,6 +4753,11 @@ WorkerLimitCount(Node *limitCount, Node *limitOffset, OrderByLimitReference
 	{
 		canPushDownLimit = LIMIT_CAN_PUSHDOWN;
 	}
+	else if (orderByLimitReference.groupCoveringSortPrefixLength > 0 ||
+			 orderByLimitReference.orderByMinMaxAggregate)
+	{
+		canPushDownLimit = LIMIT_CAN_PUSHDOWN;
+	}
 	else if (orderByLimitReference.canApproximate)
 	{
 		canPushDownLimit = LIMIT_CAN_APPROXIMATE;
@@ -4740,6 +4772,14 @@ WorkerLimitCount(Node *limitCount, Node *limitOffset, OrderByLimitReference
 	{
 		Const *workerLimitConst = (Const *) copyObject(limitCount);
 		int64 workerLimitCount = (int64) LimitClauseRowFetchCount;
+
+		/* fetching fewer rows than the limit cannot give a meaningful result */
+		if (!workerLimitConst->constisnull)
+		{
+			workerLimitCount = Max(workerLimitCount,
+								   DatumGetInt64(workerLimitConst->constvalue));
+		}
+
 		workerLimitConst->constvalue = Int64GetDatum(workerLimitCount);
 
 		workerLimitNode = (Node *) workerLimitConst;
@@ -4824,6 +4864,17 @@ WorkerSortClauseList(Node *limitCount, List *groupClauseList, List *sortClauseLi
 			workerSortClauseList = sortClauseList;
 			workerSortClauseList = list_concat(workerSortClauseList, groupClauseList);
 		}
+		else if (orderByLimitReference.groupCoveringSortPrefixLength > 0)
+		{
+			/* groups are unique, so the remaining sort clauses do not matter */
+			workerSortClauseList =
+				list_truncate(sortClauseList,
+							  orderByLimitReference.groupCoveringSortPrefixLength);
+		}
+		else if (orderByLimitReference.orderByMinMaxAggregate)
+		{
+			workerSortClauseList = sortClauseList;
+		}
 		else if (canApproximate)
 		{
 			workerSortClauseList = sortClauseList;
@@ -4893,6 +4944,146 @@ HasOrderByAggregate(List *sortClauseList, List *targetList)
 }
 
 
+/*
+ * GroupCoveringSortPrefixLength returns the length of the shortest prefix of
+ * the sort clauses which does not contain aggregates and covers all group by
+ * clauses, or 0 if there is no such prefix.
+ *
+ * When such a prefix exists, the order of the groups is fully determined by
+ * the group by values, which are identical on all shards. The first N groups
+ * of the result are then among the first N groups of every shard.
+ */
+static int
+GroupCoveringSortPrefixLength(List *sortClauseList, List *groupClauseList,
+							  List *targetList)
+{
+	List *remainingGroupRefList = NIL;
+	int prefixLength = 0;
+
+	SortGroupClause *groupClause = NULL;
+	foreach_ptr(groupClause, groupClauseList)
+	{
+		remainingGroupRefList = list_append_unique_int(remainingGroupRefList,
+													   groupClause->tleSortGroupRef);
+	}
+
+	if (remainingGroupRefList == NIL)
+	{
+		return 0;
+	}
+
+	SortGroupClause *sortClause = NULL;
+	foreach_ptr(sortClause, sortClauseList)
+	{
+		Node *sortExpression = get_sortgroupclause_expr(sortClause, targetList);
+		if (contain_aggs_of_level(sortExpression, 0))
+		{
+			return 0;
+		}
+
+		prefixLength++;
+
+		remainingGroupRefList = list_delete_int(remainingGroupRefList,
+												sortClause->tleSortGroupRef);
+		if (remainingGroupRefList == NIL)
+		{
+			return prefixLength;
+		}
+	}
+
+	return 0;
+}
+
+
+/*
+ * OrderByMinMaxAggregate returns true if the first sort clause is either
+ * max() DESC NULLS LAST or min() ASC NULLS LAST, and any further sort clauses
+ * are group by clauses.
+ *
+ * Consider a group g whose max() is attained on shard s. Any group that is
+ * ordered before g on shard s has a larger or equal max() overall, so it is
+ * also ordered before g in the final result. Hence if g is among the first N
+ * groups of the result, it is among the first N groups of shard s, and its
+ * final max() is the one fetched from shard s. The same holds for min() in
+ * ascending order. Other aggregates of g might miss values from other shards,
+ * so we only allow the ordering aggregate in the target list. NULLs need to
+ * come last, since a group that is entirely
+ * NULL on one shard may still have non-NULL values on other shards.
+ */
+static bool
+OrderByMinMaxAggregate(List *sortClauseList, List *groupClauseList, List *targetList)
+{
+	if (sortClauseList == NIL)
+	{
+		return false;
+	}
+
+	SortGroupClause *firstSortClause = (SortGroupClause *) linitial(sortClauseList);
+	Node *firstSortExpression = get_sortgroupclause_expr(firstSortClause, targetList);
+	if (!IsA(firstSortExpression, Aggref) || firstSortClause->nulls_first)
+	{
+		return false;
+	}
+
+	Aggref *aggregate = (Aggref *) firstSortExpression;
+	AggregateType aggregateType = GetAggregateType(aggregate);
+	if (aggregateType != AGGREGATE_MAX && aggregateType != AGGREGATE_MIN)
+	{
+		return false;
+	}
+
+	/*
+	 * max() and min() are defined through their sort operators, which are the
+	 * operators used by DESC and ASC ordering respectively. Requiring the sort
+	 * clause to use the same operator thus also ensures the right direction.
+	 */
+	HeapTuple aggTuple = SearchSysCache1(AGGFNOID,
+										 ObjectIdGetDatum(aggregate->aggfnoid));
+	if (!HeapTupleIsValid(aggTuple))
+	{
+		return false;
+	}
+
+	Oid aggregateSortOperatorId = ((Form_pg_aggregate) GETSTRUCT(aggTuple))->aggsortop;
+	ReleaseSysCache(aggTuple);
+
+	if (!OidIsValid(aggregateSortOperatorId) ||
+		firstSortClause->sortop != aggregateSortOperatorId)
+	{
+		return false;
+	}
+
+	SortGroupClause *sortClause = NULL;
+	foreach_ptr(sortClause, list_copy_tail(sortClauseList, 1))
+	{
+		if (get_sortgroupref_clause_noerr(sortClause->tleSortGroupRef,
+										  groupClauseList) == NULL)
+		{
+			return false;
+		}
+	}
+
+	/*
+	 * Only the ordering aggregate is guaranteed to be complete for the groups
+	 * we fetch, so it must be the only aggregate in the target list.
+	 */
+	List *expressionList = pull_var_clause((Node *) targetList,
+										   PVC_INCLUDE_AGGREGATES |
+										   PVC_INCLUDE_WINDOWFUNCS);
+	Node *expression = NULL;
+	foreach_ptr(expression, expressionList)
+	{
+		if (IsA(expression, WindowFunc) ||
+			(IsA(expression, Aggref) && !equal(expression, aggregate)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 /*
  * HasOrderByNonCommutativeAggregate walks over the given order by clauses,
  * and checks if we have an order by an aggregate which is not commutative.
@@ -193,6 +193,9 @@ static bool PartitionedOnColumn(Var *column, List *rangeTableList,
 								List *dependentJobList);
 static void CheckJoinBetweenColumns(OpExpr *joinClause);
 static List * FindRangeTableFragmentsList(List *rangeTableFragmentsList, int taskId);
+static bool NestedFragmentPrunable(List *fragmentCombination,
+								   RangeTableFragment *tableFragment);
+static bool ShardPlacementsOnSameGroups(uint64 firstShardId, uint64 secondShardId);
 static bool JoinPrunable(RangeTableFragment *leftFragment,
 						 RangeTableFragment *rightFragment);
 static ShardInterval * FragmentInterval(RangeTableFragment *fragment);
@@ -2604,6 +2607,134 @@ CoPartitionedTables(Oid firstRelationId, Oid secondRelationId)
 }
 
 
+/*
+ * NestedShardRangeTables checks if every shard of the given finer hash distributed
+ * table falls entirely within the hash range of a single shard of the coarser
+ * table, and if each such pair of shards is placed on the same set of nodes. A
+ * join on the distribution columns of these tables can then be executed by joining
+ * each shard of the finer table with its covering shard of the coarser table,
+ * without repartitioning.
+ *
+ * The shard ranges of, for example, a 128 shard and a 32 shard table always nest.
+ * However, shards are placed round-robin when tables are created, so with more
+ * than one worker the covering shards usually end up on other nodes. The
+ * placements only line up when both tables are replicated to all nodes, or when
+ * shards were moved next to each other.
+ */
+bool
+NestedShardRangeTables(Oid finerRelationId, Oid coarserRelationId)
+{
+	CitusTableCacheEntry *finerTableCache = GetCitusTableCacheEntry(finerRelationId);
+	CitusTableCacheEntry *coarserTableCache = GetCitusTableCacheEntry(coarserRelationId);
+
+	if (!IsCitusTableTypeCacheEntry(finerTableCache, HASH_DISTRIBUTED) ||
+		!IsCitusTableTypeCacheEntry(coarserTableCache, HASH_DISTRIBUTED))
+	{
+		return false;
+	}
+
+	if (finerTableCache->hasUninitializedShardInterval ||
+		coarserTableCache->hasUninitializedShardInterval)
+	{
+		return false;
+	}
+
+	/* both tables need to hash the same values to the same tokens */
+	Var *finerPartitionColumn = finerTableCache->partitionColumn;
+	Var *coarserPartitionColumn = coarserTableCache->partitionColumn;
+	if (finerPartitionColumn->vartype != coarserPartitionColumn->vartype ||
+		finerPartitionColumn->varcollid != coarserPartitionColumn->varcollid)
+	{
+		return false;
+	}
+
+	int finerShardCount = finerTableCache->shardIntervalArrayLength;
+	int coarserShardCount = coarserTableCache->shardIntervalArrayLength;
+	if (coarserShardCount == 0 || finerShardCount < coarserShardCount)
+	{
+		return false;
+	}
+
+	int coarserShardIndex = 0;
+	for (int finerShardIndex = 0; finerShardIndex < finerShardCount; finerShardIndex++)
+	{
+		ShardInterval *finerInterval =
+			finerTableCache->sortedShardIntervalArray[finerShardIndex];
+		int32 finerMinValue = DatumGetInt32(finerInterval->minValue);
+		int32 finerMaxValue = DatumGetInt32(finerInterval->maxValue);
+
+		/* both arrays are sorted, so we only ever need to move forward */
+		ShardInterval *coarserInterval =
+			coarserTableCache->sortedShardIntervalArray[coarserShardIndex];
+		while (DatumGetInt32(coarserInterval->maxValue) < finerMinValue)
+		{
+			coarserShardIndex++;
+			if (coarserShardIndex >= coarserShardCount)
+			{
+				return false;
+			}
+
+			coarserInterval =
+				coarserTableCache->sortedShardIntervalArray[coarserShardIndex];
+		}
+
+		if (DatumGetInt32(coarserInterval->minValue) > finerMinValue ||
+			DatumGetInt32(coarserInterval->maxValue) < finerMaxValue)
+		{
+			return false;
+		}
+
+		if (!ShardPlacementsOnSameGroups(finerInterval->shardId,
+										 coarserInterval->shardId))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/*
+ * ShardPlacementsOnSameGroups returns true if the active placements of the given
+ * shards are on exactly the same set of node groups.
+ */
+static bool
+ShardPlacementsOnSameGroups(uint64 firstShardId, uint64 secondShardId)
+{
+	List *firstPlacementList = ActiveShardPlacementList(firstShardId);
+	List *secondPlacementList = ActiveShardPlacementList(secondShardId);
+
+	if (list_length(firstPlacementList) != list_length(secondPlacementList))
+	{
+		return false;
+	}
+
+	ShardPlacement *firstPlacement = NULL;
+	foreach_ptr(firstPlacement, firstPlacementList)
+	{
+		bool foundGroup = false;
+
+		ShardPlacement *secondPlacement = NULL;
+		foreach_ptr(secondPlacement, secondPlacementList)
+		{
+			if (secondPlacement->groupId == firstPlacement->groupId)
+			{
+				foundGroup = true;
+				break;
+			}
+		}
+
+		if (!foundGroup)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 /*
  * SqlTaskList creates a list of SQL tasks to execute the given job. For this,
  * the function walks over each range table in the job's range table list, gets
@@ -3397,6 +3528,12 @@ FragmentCombinationList(List *rangeTableFragmentsList, Query *jobQuery,
 				joinPrunable = JoinPrunable(joiningTableFragment, tableFragment);
 			}
 
+			if (!joinPrunable)
+			{
+				joinPrunable = NestedFragmentPrunable(fragmentCombination,
+													  tableFragment);
+			}
+
 			/* if join can't be pruned, extend fragment combination and search */
 			if (!joinPrunable)
 			{
@@ -3877,6 +4014,55 @@ JoinPrunable(RangeTableFragment *leftFragment, RangeTableFragment *rightFragment
 }
 
 
+/*
+ * NestedFragmentPrunable checks if the given shard fragment can be pruned away
+ * because it does not overlap with the shard of a non-colocated table that is
+ * already in the fragment combination. Such tables only end up in the same job
+ * through a local join between tables with nested shard ranges, so they are
+ * joined on their distribution columns and each shard of the finer table should
+ * only be combined with its covering shard. Without this check, a table that is
+ * pruned against the coarser table could bring in shards from other nodes.
+ */
+static bool
+NestedFragmentPrunable(List *fragmentCombination, RangeTableFragment *tableFragment)
+{
+	if (tableFragment->fragmentType != CITUS_RTE_RELATION)
+	{
+		return false;
+	}
+
+	ShardInterval *fragmentInterval = FragmentInterval(tableFragment);
+	if (!IsCitusTableType(fragmentInterval->relationId, HASH_DISTRIBUTED))
+	{
+		return false;
+	}
+
+	RangeTableFragment *combinedFragment = NULL;
+	foreach_ptr(combinedFragment, fragmentCombination)
+	{
+		if (combinedFragment->fragmentType != CITUS_RTE_RELATION)
+		{
+			continue;
+		}
+
+		ShardInterval *combinedInterval = FragmentInterval(combinedFragment);
+		if (!IsCitusTableType(combinedInterval->relationId, HASH_DISTRIBUTED) ||
+			CoPartitionedTables(combinedInterval->relationId,
+								fragmentInterval->relationId))
+		{
+			continue;
+		}
+
+		if (!ShardIntervalsOverlap(combinedInterval, fragmentInterval))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*
  * FragmentInterval takes the given fragment, and determines the range of data
  * covered by this fragment. The function then returns this range (interval).
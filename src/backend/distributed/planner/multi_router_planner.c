@@ -53,6 +53,7 @@
 #include "distributed/relay_utility.h"
 #include "distributed/recursive_planning.h"
 #include "distributed/resource_lock.h"
+#include "distributed/shard_pruning_cache.h"
 #include "distributed/shardinterval_utils.h"
 #include "distributed/shard_pruning.h"
 #include "executor/execdesc.h"
@@ -2800,6 +2801,21 @@ TargetShardIntervalForFastPathQuery(Query *query, bool *isMultiShardQuery,
 		return list_make1(LoadShardIntervalList(relationId));
 	}
 
+	if (inputDistributionKeyValue == NULL && EnableShardPruningCache)
+	{
+		/*
+		 * With deferred pruning, parameters on the distribution column have
+		 * been replaced by constants by now. Find the value the same way the
+		 * fast-path planner does, which lets us skip PruneShards.
+		 */
+		Node *distributionKeyValue = NULL;
+		if (FastPathRouterQuery(query, &distributionKeyValue) &&
+			distributionKeyValue != NULL && IsA(distributionKeyValue, Const))
+		{
+			inputDistributionKeyValue = (Const *) distributionKeyValue;
+		}
+	}
+
 	if (inputDistributionKeyValue && !inputDistributionKeyValue->constisnull)
 	{
 		CitusTableCacheEntry *cache = GetCitusTableCacheEntry(relationId);
@@ -2818,7 +2834,7 @@ TargetShardIntervalForFastPathQuery(Query *query, bool *isMultiShardQuery,
 		}
 
 		ShardInterval *cachedShardInterval =
-			FindShardInterval(inputDistributionKeyValue->constvalue, cache);
+			FindShardIntervalCached(cache, inputDistributionKeyValue);
 		if (cachedShardInterval == NULL)
 		{
 			ereport(ERROR, (errmsg(
@@ -3037,7 +3053,8 @@ PlacementsForWorkersContainingAllShards(List *shardIntervalListList)
 		uint64 shardId = shardInterval->shardId;
 
 		/* retrieve all active shard placements for this shard */
-		List *newPlacementList = ActiveShardPlacementList(shardId);
+		List *newPlacementList =
+			CachedActiveShardPlacementList(shardInterval->relationId, shardId);
 
 		if (firstShard)
 		{
@@ -3137,11 +3154,13 @@ BuildRoutesForInsert(Query *query, DeferredErrorMessage **planningError)
 
 	/* get full list of insert values and iterate over them to prune */
 	List *insertValuesList = ExtractInsertValuesList(query, partitionColumn);
+	int insertValuesCount = list_length(insertValuesList);
+	Const **partitionValueConsts = palloc0(insertValuesCount * sizeof(Const *));
+	int insertValuesIndex = 0;
 
 	foreach(insertValuesCell, insertValuesList)
 	{
 		InsertValues *insertValues = (InsertValues *) lfirst(insertValuesCell);
-		List *prunedShardIntervalList = NIL;
 		Node *partitionValueExpr = (Node *) insertValues->partitionValueExpr;
 
 		/*
@@ -3201,15 +3220,44 @@ BuildRoutesForInsert(Query *query, DeferredErrorMessage **planningError)
 												   missingOk);
 		}
 
-		if (IsCitusTableTypeCacheEntry(cacheEntry, HASH_DISTRIBUTED) ||
-			IsCitusTableTypeCacheEntry(cacheEntry, RANGE_DISTRIBUTED))
+		partitionValueConsts[insertValuesIndex++] = partitionValueConst;
+	}
+
+	/*
+	 * For hash and range distributed tables we route all rows at once, which
+	 * avoids per-row fmgr calls for the common distribution column types.
+	 */
+	int *shardIndexes = NULL;
+	if (IsCitusTableTypeCacheEntry(cacheEntry, HASH_DISTRIBUTED) ||
+		IsCitusTableTypeCacheEntry(cacheEntry, RANGE_DISTRIBUTED))
+	{
+		ShardRoutingInfo *routingInfo = CreateShardRoutingInfo(cacheEntry);
+		Datum *partitionValues = palloc0(insertValuesCount * sizeof(Datum));
+
+		for (int valueIndex = 0; valueIndex < insertValuesCount; valueIndex++)
 		{
-			Datum partitionValue = partitionValueConst->constvalue;
+			partitionValues[valueIndex] = partitionValueConsts[valueIndex]->constvalue;
+		}
+
+		shardIndexes = palloc0(insertValuesCount * sizeof(int));
+		RouteDistributionValueBatch(routingInfo, partitionValues, insertValuesCount,
+									shardIndexes);
+	}
+
+	insertValuesIndex = 0;
+	foreach(insertValuesCell, insertValuesList)
+	{
+		InsertValues *insertValues = (InsertValues *) lfirst(insertValuesCell);
+		Const *partitionValueConst = partitionValueConsts[insertValuesIndex];
+		List *prunedShardIntervalList = NIL;
 
-			ShardInterval *shardInterval = FindShardInterval(partitionValue, cacheEntry);
-			if (shardInterval != NULL)
+		if (shardIndexes != NULL)
+		{
+			int shardIndex = shardIndexes[insertValuesIndex];
+			if (shardIndex != INVALID_SHARD_INDEX)
 			{
-				prunedShardIntervalList = list_make1(shardInterval);
+				prunedShardIntervalList =
+					list_make1(cacheEntry->sortedShardIntervalArray[shardIndex]);
 			}
 		}
 		else
@@ -3276,6 +3324,8 @@ BuildRoutesForInsert(Query *query, DeferredErrorMessage **planningError)
 
 		ShardInterval *targetShard = (ShardInterval *) linitial(prunedShardIntervalList);
 		insertValues->shardId = targetShard->shardId;
+
+		insertValuesIndex++;
 	}
 
 	modifyRouteList = GroupInsertValuesByShardId(insertValuesList);
@@ -0,0 +1,406 @@
+/*-------------------------------------------------------------------------
+ *
+ * shard_pruning_cache.c
+ *
+ * Multi-tenant workloads tend to send many router queries for a small set
+ * of hot tenants. Rather than pruning shards and looking up the active
+ * placements again for every statement, we remember which shard a given
+ * (relation, distribution column value) pair prunes to, and which
+ * placements of a shard are active.
+ *
+ * The caches are per-backend and are flushed whenever the corresponding
+ * Citus metadata cache entries are invalidated.
+ *
+ * Copyright (c) Citus Data, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "common/hashfn.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+#include "distributed/hash_helpers.h"
+#include "distributed/listutils.h"
+#include "distributed/metadata_cache.h"
+#include "distributed/metadata_utility.h"
+#include "distributed/shard_pruning_cache.h"
+#include "distributed/shardinterval_utils.h"
+
+
+/* caches are flushed when they grow beyond this number of entries */
+#define SHARD_PRUNING_CACHE_MAX_ENTRIES 8192
+
+
+/*
+ * DistributionValueCacheKey identifies a distribution column value of a
+ * relation. Since different values may have the same hash, cache entries
+ * also store the value itself.
+ */
+typedef struct DistributionValueCacheKey
+{
+	Oid relationId;
+	uint32 valueHash;
+} DistributionValueCacheKey;
+
+assert_valid_hash_key2(DistributionValueCacheKey, relationId, valueHash);
+
+typedef struct DistributionValueCacheEntry
+{
+	DistributionValueCacheKey key;
+
+	/* distribution column value, copied into ShardPruningCacheContext */
+	Datum distributionValue;
+	bool distributionValueByVal;
+
+	/* index of the shard in sortedShardIntervalArray of the relation */
+	int shardIndex;
+} DistributionValueCacheEntry;
+
+typedef struct ShardPlacementCacheEntry
+{
+	uint64 shardId;
+
+	/* relation of the shard, used for invalidation */
+	Oid relationId;
+
+	/* active placements of the shard, copied into ShardPruningCacheContext */
+	List *activePlacementList;
+} ShardPlacementCacheEntry;
+
+
+/* GUC, whether router planners may use the shard pruning cache */
+bool EnableShardPruningCache = true;
+
+static MemoryContext ShardPruningCacheContext = NULL;
+static HTAB *DistributionValueCache = NULL;
+static HTAB *ShardPlacementCache = NULL;
+
+
+static void EnsureShardPruningCache(void);
+static void ResetShardPruningCache(void);
+static void RemoveRelationFromShardPruningCache(Oid relationId);
+static void FreeCachedPlacementList(List *placementList);
+static bool DistributionValueHash(Const *distributionValue, uint32 *valueHash);
+
+
+/*
+ * FindShardIntervalCached returns the same shard interval as FindShardInterval
+ * would return for the value of the given (non-NULL) Const, which should have
+ * the type of the distribution column. Results are cached per relation and
+ * value, such that subsequent lookups for the same value skip hashing and the
+ * shard interval search.
+ */
+ShardInterval *
+FindShardIntervalCached(CitusTableCacheEntry *cacheEntry, Const *distributionValue)
+{
+	uint32 valueHash = 0;
+
+	if (!EnableShardPruningCache ||
+		!HasDistributionKeyCacheEntry(cacheEntry) ||
+		!DistributionValueHash(distributionValue, &valueHash))
+	{
+		return FindShardInterval(distributionValue->constvalue, cacheEntry);
+	}
+
+	EnsureShardPruningCache();
+
+	DistributionValueCacheKey key = {
+		.relationId = cacheEntry->relationId,
+		.valueHash = valueHash
+	};
+	bool found = false;
+	DistributionValueCacheEntry *valueEntry =
+		hash_search(DistributionValueCache, &key, HASH_FIND, &found);
+	if (found && datumIsEqual(valueEntry->distributionValue,
+							  distributionValue->constvalue,
+							  distributionValue->constbyval,
+							  distributionValue->constlen))
+	{
+		return cacheEntry->sortedShardIntervalArray[valueEntry->shardIndex];
+	}
+
+	ShardInterval *shardInterval =
+		FindShardInterval(distributionValue->constvalue, cacheEntry);
+	if (shardInterval == NULL)
+	{
+		/* we do not cache failures, the caller will most likely error out */
+		return NULL;
+	}
+
+	if (hash_get_num_entries(DistributionValueCache) >= SHARD_PRUNING_CACHE_MAX_ENTRIES)
+	{
+		ResetShardPruningCache();
+		EnsureShardPruningCache();
+	}
+
+	valueEntry = hash_search(DistributionValueCache, &key, HASH_ENTER, &found);
+	if (found && !distributionValue->constbyval)
+	{
+		/* hash collision, replace the previous value */
+		pfree(DatumGetPointer(valueEntry->distributionValue));
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(ShardPruningCacheContext);
+	valueEntry->distributionValue = datumCopy(distributionValue->constvalue,
+											  distributionValue->constbyval,
+											  distributionValue->constlen);
+	MemoryContextSwitchTo(oldContext);
+
+	valueEntry->distributionValueByVal = distributionValue->constbyval;
+	valueEntry->shardIndex = shardInterval->shardIndex;
+
+	return shardInterval;
+}
+
+
+/*
+ * CachedActiveShardPlacementList returns the same list as
+ * ActiveShardPlacementList, but remembers the result for subsequent calls.
+ * The returned list and placements are copies that the caller may modify.
+ * relationId should be the relation of the shard, entries are invalidated
+ * along with the metadata cache entry of that relation.
+ */
+List *
+CachedActiveShardPlacementList(Oid relationId, uint64 shardId)
+{
+	if (!EnableShardPruningCache)
+	{
+		return ActiveShardPlacementList(shardId);
+	}
+
+	EnsureShardPruningCache();
+
+	bool found = false;
+	ShardPlacementCacheEntry *placementEntry =
+		hash_search(ShardPlacementCache, &shardId, HASH_FIND, &found);
+	if (found)
+	{
+		return copyObject(placementEntry->activePlacementList);
+	}
+
+	/*
+	 * Reading the placements may process invalidation messages, which could
+	 * reset the cache. Hence we only enter the cache after we have the result.
+	 */
+	List *activePlacementList = ActiveShardPlacementList(shardId);
+
+	EnsureShardPruningCache();
+
+	if (hash_get_num_entries(ShardPlacementCache) >= SHARD_PRUNING_CACHE_MAX_ENTRIES)
+	{
+		ResetShardPruningCache();
+		EnsureShardPruningCache();
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(ShardPruningCacheContext);
+	List *cachedPlacementList = copyObject(activePlacementList);
+	MemoryContextSwitchTo(oldContext);
+
+	placementEntry = hash_search(ShardPlacementCache, &shardId, HASH_ENTER, &found);
+	placementEntry->relationId = relationId;
+	placementEntry->activePlacementList = cachedPlacementList;
+
+	return activePlacementList;
+}
+
+
+/*
+ * InvalidateShardPruningCache is called when the metadata cache entries of
+ * the given relation, or of all relations when relationId is InvalidOid, are
+ * invalidated.
+ *
+ * The shards of a relation, and hence shard indexes, may change whenever its
+ * metadata is invalidated, so we remove all entries of the relation. Other
+ * relations keep their entries.
+ */
+void
+InvalidateShardPruningCache(Oid relationId)
+{
+	if (relationId == InvalidOid)
+	{
+		ResetShardPruningCache();
+	}
+	else
+	{
+		RemoveRelationFromShardPruningCache(relationId);
+	}
+}
+
+
+/*
+ * RemoveRelationFromShardPruningCache removes the distribution value and
+ * placement entries of the given relation from the shard pruning cache.
+ */
+static void
+RemoveRelationFromShardPruningCache(Oid relationId)
+{
+	HASH_SEQ_STATUS status;
+
+	if (DistributionValueCache != NULL)
+	{
+		DistributionValueCacheEntry *valueEntry = NULL;
+
+		hash_seq_init(&status, DistributionValueCache);
+		while ((valueEntry = hash_seq_search(&status)) != NULL)
+		{
+			if (valueEntry->key.relationId != relationId)
+			{
+				continue;
+			}
+
+			if (!valueEntry->distributionValueByVal)
+			{
+				pfree(DatumGetPointer(valueEntry->distributionValue));
+			}
+
+			hash_search(DistributionValueCache, &valueEntry->key, HASH_REMOVE, NULL);
+		}
+	}
+
+	if (ShardPlacementCache != NULL)
+	{
+		ShardPlacementCacheEntry *placementEntry = NULL;
+
+		hash_seq_init(&status, ShardPlacementCache);
+		while ((placementEntry = hash_seq_search(&status)) != NULL)
+		{
+			if (placementEntry->relationId != relationId)
+			{
+				continue;
+			}
+
+			FreeCachedPlacementList(placementEntry->activePlacementList);
+
+			hash_search(ShardPlacementCache, &placementEntry->shardId, HASH_REMOVE,
+						NULL);
+		}
+	}
+}
+
+
+/*
+ * EnsureShardPruningCache creates the memory context and hash tables of the
+ * shard pruning cache if they do not exist yet.
+ */
+static void
+EnsureShardPruningCache(void)
+{
+	if (ShardPruningCacheContext == NULL)
+	{
+		ShardPruningCacheContext = AllocSetContextCreate(CacheMemoryContext,
+														 "ShardPruningCacheContext",
+														 ALLOCSET_DEFAULT_SIZES);
+	}
+
+	if (DistributionValueCache == NULL)
+	{
+		HASHCTL info;
+		MemSet(&info, 0, sizeof(info));
+		info.keysize = sizeof(DistributionValueCacheKey);
+		info.entrysize = sizeof(DistributionValueCacheEntry);
+		info.hash = tag_hash;
+		info.hcxt = ShardPruningCacheContext;
+
+		DistributionValueCache =
+			hash_create("Distribution Value Cache", 64, &info,
+						HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+
+	if (ShardPlacementCache == NULL)
+	{
+		HASHCTL info;
+		MemSet(&info, 0, sizeof(info));
+		info.keysize = sizeof(uint64);
+		info.entrysize = sizeof(ShardPlacementCacheEntry);
+		info.hash = tag_hash;
+		info.hcxt = ShardPruningCacheContext;
+
+		ShardPlacementCache =
+			hash_create("Active Shard Placement Cache", 64, &info,
+						HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+}
+
+
+/*
+ * ResetShardPruningCache frees all memory used by the shard pruning cache.
+ */
+static void
+ResetShardPruningCache(void)
+{
+	if (ShardPruningCacheContext == NULL)
+	{
+		return;
+	}
+
+	/* the hash tables live in the context as well */
+	MemoryContextReset(ShardPruningCacheContext);
+	DistributionValueCache = NULL;
+	ShardPlacementCache = NULL;
+}
+
+
+/*
+ * FreeCachedPlacementList frees a placement list that was copied into
+ * ShardPruningCacheContext.
+ */
+static void
+FreeCachedPlacementList(List *placementList)
+{
+	ShardPlacement *placement = NULL;
+	foreach_ptr(placement, placementList)
+	{
+		if (placement->nodeName != NULL)
+		{
+			pfree(placement->nodeName);
+		}
+
+		pfree(placement);
+	}
+
+	list_free(placementList);
+}
+
+
+/*
+ * DistributionValueHash computes a hash of the binary representation of the
+ * given Const, which is only used to find candidate cache entries. It returns
+ * false for values that we do not cache.
+ */
+static bool
+DistributionValueHash(Const *distributionValue, uint32 *valueHash)
+{
+	if (distributionValue->constisnull)
+	{
+		return false;
+	}
+
+	Datum value = distributionValue->constvalue;
+
+	if (distributionValue->constbyval)
+	{
+		*valueHash = hash_bytes((const unsigned char *) &value, sizeof(Datum));
+		return true;
+	}
+
+	if (distributionValue->constlen == -1)
+	{
+		struct varlena *varlenaValue = (struct varlena *) DatumGetPointer(value);
+
+		/* toasted values are rare as distribution values, skip them */
+		if (VARATT_IS_EXTERNAL(varlenaValue) || VARATT_IS_COMPRESSED(varlenaValue))
+		{
+			return false;
+		}
+	}
+
+	Size valueSize = datumGetSize(value, distributionValue->constbyval,
+								  distributionValue->constlen);
+	*valueHash = hash_bytes((const unsigned char *) DatumGetPointer(value),
+							(int) valueSize);
+
+	return true;
+}
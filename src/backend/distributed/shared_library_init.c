@@ -9,6 +9,7 @@
 
 #include "postgres.h"
 
+#include <float.h>
 #include <limits.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -84,6 +85,7 @@
 #include "distributed/time_constants.h"
 #include "distributed/query_stats.h"
 #include "distributed/remote_commands.h"
+#include "distributed/shard_pruning_cache.h"
 #include "distributed/shard_rebalancer.h"
 #include "distributed/shared_library_init.h"
 #include "distributed/statistics_collection.h"
@@ -847,6 +849,9 @@ RegisterExternalClientBackendCounterDecrement(void)
 static void
 CitusCleanupConnectionsAtExit(int code, Datum arg)
 {
+	/* stop advertising that we wait for a connection slot, if we do */
+	UnregisterSharedConnectionWaiter();
+
 	/* properly close all the cached connections */
 	ShutdownAllConnections();
 
@@ -1373,6 +1378,23 @@ RegisterCitusConfigVariables(void)
 		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		"citus.enable_nested_shard_range_joins",
+		gettext_noop("Enables local joins between non-colocated hash distributed "
+					 "tables whose shard ranges nest."),
+		gettext_noop("When each shard of one table falls within the hash range "
+					 "of a single shard of another table that is placed on the "
+					 "same nodes, joins on the distribution columns are executed "
+					 "by joining each shard with its covering shard instead of "
+					 "repartitioning. Since shards are placed round-robin, this "
+					 "usually requires the tables to be replicated to all nodes "
+					 "or the shards to be moved next to each other."),
+		&EnableNestedShardRangeJoins,
+		false,
+		PGC_USERSET,
+		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		"citus.enable_non_colocated_router_query_pushdown",
 		gettext_noop("Enables router planner for the queries that reference "
@@ -1437,6 +1459,19 @@ RegisterCitusConfigVariables(void)
 		GUC_STANDARD,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		"citus.enable_shard_pruning_cache",
+		gettext_noop("Enables caching shard pruning results of router queries."),
+		gettext_noop("When enabled, each backend remembers the shard that a "
+					 "distribution column value of a table prunes to, and the "
+					 "active placements of shards targeted by router queries. "
+					 "The cache is flushed whenever Citus metadata changes."),
+		&EnableShardPruningCache,
+		true,
+		PGC_USERSET,
+		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		"citus.enable_single_hash_repartition_joins",
 		gettext_noop("Enables single hash repartitioning between hash "
@@ -2366,6 +2401,21 @@ RegisterCitusConfigVariables(void)
 		ShowShardsForAppNamePrefixesAssignHook,
 		NULL);
 
+	DefineCustomBoolVariable(
+		"citus.skip_2pc_for_single_node_transactions",
+		gettext_noop("Commits without two-phase commit when only a single "
+					 "remote transaction did modifications."),
+		gettext_noop("Modifications over multiple shards normally use two-phase "
+					 "commit. When all of them went over a single connection "
+					 "and nothing was written locally, committing that "
+					 "connection's transaction is atomic by itself and the "
+					 "PREPARE TRANSACTION round trip can be skipped."),
+		&Skip2PCForSingleNodeTransactions,
+		false,
+		PGC_USERSET,
+		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		"citus.skip_advisory_lock_permission_checks",
 		gettext_noop("Postgres would normally enforce some "
@@ -2380,6 +2430,23 @@ RegisterCitusConfigVariables(void)
 		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		"citus.skip_binary_validation_in_copy",
+		gettext_noop("Skip decoding of variable length columns on the coordinator "
+					 "during binary COPY into a distributed table"),
+		gettext_noop("When the input of COPY is in binary format, the coordinator "
+					 "normally decodes every column and encodes it again for the "
+					 "workers. If this GUC is set, the bytes of variable length "
+					 "columns other than the distribution column are forwarded to "
+					 "the workers as is, which lowers the CPU usage of the "
+					 "coordinator. Malformed values are then only detected on the "
+					 "workers, without the line number of the input."),
+		&SkipBinaryValidationInCopy,
+		false,
+		PGC_USERSET,
+		GUC_STANDARD,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		"citus.skip_constraint_validation",
 		gettext_noop("Skip validation of constraints"),
@@ -2466,6 +2533,20 @@ RegisterCitusConfigVariables(void)
 		GUC_STANDARD,
 		NULL, NULL, NULL);
 
+	DefineCustomRealVariable(
+		"citus.stat_tenants_cpu_limit",
+		gettext_noop("Sets the CPU time in seconds a tenant can use within a "
+					 "citus.stat_tenants_period."),
+		gettext_noop("Queries of a tenant that already used more CPU time than this "
+					 "within the current period are rejected until the next period "
+					 "starts. Only tenants tracked in citus_stat_tenants are "
+					 "limited. 0 disables the limit."),
+		&StatTenantsCpuLimit,
+		0, 0, DBL_MAX,
+		PGC_SUSET,
+		GUC_STANDARD,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		"citus.stat_tenants_limit",
 		gettext_noop("Number of tenants to be shown in citus_stat_tenants."),
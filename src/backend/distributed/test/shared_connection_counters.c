@@ -17,11 +17,13 @@
 #include "distributed/shared_connection_stats.h"
 #include "distributed/listutils.h"
 #include "nodes/parsenodes.h"
+#include "utils/builtins.h"
 #include "utils/guc.h"
 
 /* exports for SQL callable functions */
 PG_FUNCTION_INFO_V1(wake_up_connection_pool_waiters);
 PG_FUNCTION_INFO_V1(set_max_shared_pool_size);
+PG_FUNCTION_INFO_V1(shared_connection_waiter_count);
 
 
 /*
@@ -37,6 +39,23 @@ wake_up_connection_pool_waiters(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * shared_connection_waiter_count is a SQL interface for testing
+ * SharedConnectionWaiterCount().
+ */
+Datum
+shared_connection_waiter_count(PG_FUNCTION_ARGS)
+{
+	text *nodeNameText = PG_GETARG_TEXT_P(0);
+	int32 nodePort = PG_GETARG_INT32(1);
+
+	int waiterCount = SharedConnectionWaiterCount(text_to_cstring(nodeNameText),
+												  nodePort);
+
+	PG_RETURN_INT32(waiterCount);
+}
+
+
 /*
  * makeIntConst creates a Const Node that stores a given integer
  *
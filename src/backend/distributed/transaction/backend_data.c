@@ -79,6 +79,21 @@ typedef struct BackendManagementShmemData
 	BackendData backends[FLEXIBLE_ARRAY_MEMBER];
 } BackendManagementShmemData;
 
+/*
+ * ActiveBackendSnapshot is a backend-local copy of the fields of an active
+ * backend that StoreAllActiveTransactions() reports.
+ */
+typedef struct ActiveBackendSnapshot
+{
+	Oid databaseId;
+	int backendPid;
+	Oid roleId;
+	bool distributedCommandOriginator;
+	uint64 transactionNumber;
+	TimestampTz transactionIdTimestamp;
+	uint64 globalPID;
+} ActiveBackendSnapshot;
+
 /*
  * CitusBackendType reflects what type of backend we are in. This
  * can change depending on the application_name.
@@ -373,6 +388,11 @@ get_all_active_transactions(PG_FUNCTION_ARGS)
 /*
  * StoreAllActiveTransactions gets active transaction from the local node and inserts
  * them into the given tuplestore.
+ *
+ * The backend data is copied into a local snapshot while holding the backend
+ * shared memory lock, and the lock is released before doing anything that may
+ * be expensive, such as permission checks or writing into the tuplestore. That
+ * keeps new backends from being blocked by monitoring queries.
  */
 static void
 StoreAllActiveTransactions(Tuplestorestate *tupleStore, TupleDesc tupleDescriptor)
@@ -387,18 +407,21 @@ StoreAllActiveTransactions(Tuplestorestate *tupleStore, TupleDesc tupleDescripto
 		showAllBackends = true;
 	}
 
+	/* allocate before taking the lock, TotalProcCount() is fixed after startup */
+	int totalProcCount = TotalProcCount();
+	ActiveBackendSnapshot *activeBackends =
+		palloc(totalProcCount * sizeof(ActiveBackendSnapshot));
+	int activeBackendCount = 0;
+
 	/* we're reading all distributed transactions, prevent new backends */
 	LockBackendSharedMemory(LW_SHARED);
 
-	for (int backendIndex = 0; backendIndex < TotalProcCount(); ++backendIndex)
+	for (int backendIndex = 0; backendIndex < totalProcCount; ++backendIndex)
 	{
-		bool showCurrentBackendDetails = showAllBackends;
 		BackendData *currentBackend =
 			&backendManagementShmemData->backends[backendIndex];
 		PGPROC *currentProc = &ProcGlobal->allProcs[backendIndex];
-
-		/* to work on data after releasing g spinlock to protect against errors */
-		uint64 transactionNumber = 0;
+		ActiveBackendSnapshot *snapshot = &activeBackends[activeBackendCount];
 
 		SpinLockAcquire(&currentBackend->mutex);
 
@@ -409,32 +432,44 @@ StoreAllActiveTransactions(Tuplestorestate *tupleStore, TupleDesc tupleDescripto
 			continue;
 		}
 
-		/*
-		 * Unless the user has a role that allows seeing all transactions (superuser,
-		 * pg_monitor), we only follow pg_stat_statements owner checks.
-		 */
-		if (!showCurrentBackendDetails &&
-			UserHasPermissionToViewStatsOf(userId, currentProc->roleId))
-		{
-			showCurrentBackendDetails = true;
-		}
-
-		Oid databaseId = currentBackend->databaseId;
-		int backendPid = ProcGlobal->allProcs[backendIndex].pid;
+		snapshot->databaseId = currentBackend->databaseId;
+		snapshot->backendPid = currentProc->pid;
+		snapshot->roleId = currentProc->roleId;
 
 		/*
 		 * We prefer to use worker_query instead of distributedCommandOriginator in
 		 * the user facing functions since it's more intuitive. Thus,
 		 * we negate the result before returning.
 		 */
-		bool distributedCommandOriginator =
+		snapshot->distributedCommandOriginator =
 			currentBackend->distributedCommandOriginator;
 
-		transactionNumber = currentBackend->transactionId.transactionNumber;
-		TimestampTz transactionIdTimestamp = currentBackend->transactionId.timestamp;
+		snapshot->transactionNumber = currentBackend->transactionId.transactionNumber;
+		snapshot->transactionIdTimestamp = currentBackend->transactionId.timestamp;
+		snapshot->globalPID = currentBackend->globalPID;
 
 		SpinLockRelease(&currentBackend->mutex);
 
+		activeBackendCount++;
+	}
+
+	UnlockBackendSharedMemory();
+
+	for (int backendIndex = 0; backendIndex < activeBackendCount; ++backendIndex)
+	{
+		ActiveBackendSnapshot *snapshot = &activeBackends[backendIndex];
+		bool showCurrentBackendDetails = showAllBackends;
+
+		/*
+		 * Unless the user has a role that allows seeing all transactions (superuser,
+		 * pg_monitor), we only follow pg_stat_statements owner checks.
+		 */
+		if (!showCurrentBackendDetails &&
+			UserHasPermissionToViewStatsOf(userId, snapshot->roleId))
+		{
+			showCurrentBackendDetails = true;
+		}
+
 		memset(values, 0, sizeof(values));
 		memset(isNulls, false, sizeof(isNulls));
 
@@ -451,39 +486,31 @@ StoreAllActiveTransactions(Tuplestorestate *tupleStore, TupleDesc tupleDescripto
 		{
 			bool missingOk = true;
 			int initiatorNodeId =
-				ExtractNodeIdFromGlobalPID(currentBackend->globalPID, missingOk);
+				ExtractNodeIdFromGlobalPID(snapshot->globalPID, missingOk);
 
-			values[0] = ObjectIdGetDatum(databaseId);
-			values[1] = Int32GetDatum(backendPid);
+			values[0] = ObjectIdGetDatum(snapshot->databaseId);
+			values[1] = Int32GetDatum(snapshot->backendPid);
 			values[2] = Int32GetDatum(initiatorNodeId);
-			values[3] = !distributedCommandOriginator;
-			values[4] = UInt64GetDatum(transactionNumber);
-			values[5] = TimestampTzGetDatum(transactionIdTimestamp);
-			values[6] = UInt64GetDatum(currentBackend->globalPID);
+			values[3] = !snapshot->distributedCommandOriginator;
+			values[4] = UInt64GetDatum(snapshot->transactionNumber);
+			values[5] = TimestampTzGetDatum(snapshot->transactionIdTimestamp);
+			values[6] = UInt64GetDatum(snapshot->globalPID);
 		}
 		else
 		{
 			isNulls[0] = true;
-			values[1] = Int32GetDatum(backendPid);
+			values[1] = Int32GetDatum(snapshot->backendPid);
 			isNulls[2] = true;
-			values[3] = !distributedCommandOriginator;
+			values[3] = !snapshot->distributedCommandOriginator;
 			isNulls[4] = true;
 			isNulls[5] = true;
-			values[6] = UInt64GetDatum(currentBackend->globalPID);
+			values[6] = UInt64GetDatum(snapshot->globalPID);
 		}
 
 		tuplestore_putvalues(tupleStore, tupleDescriptor, values, isNulls);
-
-		/*
-		 * We don't want to initialize memory while spinlock is held so we
-		 * prefer to do it here. This initialization is done for the rows
-		 * starting from the second one.
-		 */
-		memset(values, 0, sizeof(values));
-		memset(isNulls, false, sizeof(isNulls));
 	}
 
-	UnlockBackendSharedMemory();
+	pfree(activeBackends);
 }
 
 
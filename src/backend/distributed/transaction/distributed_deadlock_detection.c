@@ -53,6 +53,7 @@ static void BuildDeadlockPathList(QueuedTransactionNode *cycledTransactionNode,
 								  TransactionNode **transactionNodeStack,
 								  List **deadlockPath);
 static void ResetVisitedFields(HTAB *adjacencyList);
+static void MarkTransactionNodesThatCannotDeadlock(HTAB *adjacencyList);
 static bool AssociateDistributedTransactionWithBackendProc(TransactionNode *
 														   transactionNode);
 static TransactionNode * GetOrCreateTransactionNode(HTAB *adjacencyList,
@@ -127,6 +128,13 @@ CheckForDistributedDeadlocks(void)
 
 	int edgeCount = waitGraph->edgeCount;
 
+	/*
+	 * Most waits on a busy cluster are not part of a deadlock. Filter out the
+	 * transactions that cannot be on a cycle once, such that we only need to
+	 * do a DFS for the few that can.
+	 */
+	MarkTransactionNodesThatCannotDeadlock(adjacencyLists);
+
 	/*
 	 * We iterate on transaction nodes and search for deadlocks where the
 	 * starting node is the given transaction node.
@@ -148,6 +156,11 @@ CheckForDistributedDeadlocks(void)
 			continue;
 		}
 
+		if (transactionNode->cannotDeadlock)
+		{
+			continue;
+		}
+
 		ResetVisitedFields(adjacencyLists);
 
 		bool deadlockFound = CheckDeadlockForTransactionNode(transactionNode,
@@ -307,6 +320,12 @@ PrependOutgoingNodesToQueue(TransactionNode *transactionNode, int currentStackDe
 	TransactionNode *waitForTransaction = NULL;
 	foreach_ptr(waitForTransaction, transactionNode->waitsFor)
 	{
+		/* a transaction that is not on any cycle cannot lead back to us */
+		if (waitForTransaction->cannotDeadlock)
+		{
+			continue;
+		}
+
 		QueuedTransactionNode *queuedNode = palloc0(sizeof(QueuedTransactionNode));
 
 		queuedNode->transactionNode = waitForTransaction;
@@ -357,6 +376,62 @@ ResetVisitedFields(HTAB *adjacencyList)
 }
 
 
+/*
+ * MarkTransactionNodesThatCannotDeadlock sets cannotDeadlock for all transaction
+ * nodes in the adjacency list that are not on a cycle, and do not only wait for
+ * transactions on a cycle.
+ *
+ * A transaction that does not wait for anything cannot be on a cycle. Neither
+ * can a transaction that only waits for such transactions. We therefore
+ * repeatedly peel off transactions whose remaining waitsFor entries all cannot
+ * deadlock, which takes time linear in the size of the wait graph. All
+ * transactions on a cycle are left unmarked, so skipping the marked ones never
+ * hides a deadlock.
+ */
+static void
+MarkTransactionNodesThatCannotDeadlock(HTAB *adjacencyList)
+{
+	HASH_SEQ_STATUS status;
+	TransactionNode *transactionNode = NULL;
+	List *peelableNodeList = NIL;
+
+	hash_seq_init(&status, adjacencyList);
+	while ((transactionNode = (TransactionNode *) hash_seq_search(&status)) != 0)
+	{
+		transactionNode->remainingWaitsForCount = list_length(transactionNode->waitsFor);
+
+		if (transactionNode->remainingWaitsForCount == 0)
+		{
+			peelableNodeList = lappend(peelableNodeList, transactionNode);
+		}
+
+		TransactionNode *blockingNode = NULL;
+		foreach_ptr(blockingNode, transactionNode->waitsFor)
+		{
+			blockingNode->waitedBy = lappend(blockingNode->waitedBy, transactionNode);
+		}
+	}
+
+	while (peelableNodeList != NIL)
+	{
+		TransactionNode *peeledNode = (TransactionNode *) llast(peelableNodeList);
+		peelableNodeList = list_delete_last(peelableNodeList);
+
+		peeledNode->cannotDeadlock = true;
+
+		TransactionNode *waitingNode = NULL;
+		foreach_ptr(waitingNode, peeledNode->waitedBy)
+		{
+			waitingNode->remainingWaitsForCount--;
+			if (waitingNode->remainingWaitsForCount == 0)
+			{
+				peelableNodeList = lappend(peelableNodeList, waitingNode);
+			}
+		}
+	}
+}
+
+
 /*
  * AssociateDistributedTransactionWithBackendProc gets a transaction node
  * and searches the corresponding backend. Once found, transactionNodes'
@@ -508,6 +583,8 @@ GetOrCreateTransactionNode(HTAB *adjacencyList, DistributedTransactionId *transa
 	if (!found)
 	{
 		transactionNode->waitsFor = NIL;
+		transactionNode->waitedBy = NIL;
+		transactionNode->cannotDeadlock = false;
 		transactionNode->initiatorProc = NULL;
 	}
 
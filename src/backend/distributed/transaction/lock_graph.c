@@ -51,6 +51,7 @@ static void AddWaitEdgeFromBlockedProcessResult(WaitGraph *waitGraph, PGresult *
 												int rowIndex);
 static void ReturnBlockedProcessGraph(WaitGraph *waitGraph, FunctionCallInfo fcinfo);
 static WaitGraph * BuildLocalWaitGraph(bool onlyDistributedTx);
+static bool AnyProcessWaitingForLock(int totalProcs);
 static bool IsProcessWaitingForSafeOperations(PGPROC *proc);
 static void LockLockData(void);
 static void UnlockLockData(void);
@@ -546,6 +547,17 @@ BuildLocalWaitGraph(bool onlyDistributedTx)
 	remaining.procAdded = (bool *) palloc0(sizeof(bool *) * totalProcs);
 	remaining.procCount = 0;
 
+	/*
+	 * Taking all the lock partition locks stalls every lock acquisition on
+	 * the node, while most of the time (e.g., when monitoring tools poll
+	 * citus_lock_waits) nobody is waiting for a lock at all. In that case
+	 * the graph is known to be empty, so skip locking altogether.
+	 */
+	if (!AnyProcessWaitingForLock(totalProcs))
+	{
+		return waitGraph;
+	}
+
 	LockLockData();
 
 	/*
@@ -640,6 +652,30 @@ BuildLocalWaitGraph(bool onlyDistributedTx)
 }
 
 
+/*
+ * AnyProcessWaitingForLock returns true if any of the processes is waiting
+ * for a lock. The check is done without holding any locks, so the result may
+ * be stale by the time it is returned. That is equivalent to having built the
+ * wait graph a moment earlier, and waits that start afterwards are seen on the
+ * next call.
+ */
+static bool
+AnyProcessWaitingForLock(int totalProcs)
+{
+	for (int curBackend = 0; curBackend < totalProcs; curBackend++)
+	{
+		PGPROC *currentProc = &ProcGlobal->allProcs[curBackend];
+
+		if (currentProc->pid != 0 && IsProcessWaitingForLock(currentProc))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*
  * IsProcessWaitingForSafeOperations returns true if the given PROC
  * waiting on relation extension locks, page locks or speculative locks.
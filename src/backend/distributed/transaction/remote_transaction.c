@@ -21,6 +21,7 @@
 
 #include "access/xact.h"
 #include "distributed/backend_data.h"
+#include "distributed/causal_clock.h"
 #include "distributed/citus_safe_lib.h"
 #include "distributed/connection_management.h"
 #include "distributed/listutils.h"
@@ -55,6 +56,11 @@ static void FinishRemoteTransactionSavepointRollback(MultiConnection *connection
 													 SubTransactionId subId);
 
 static void Assign2PCIdentifier(MultiConnection *connection);
+static void LogPreparedTransactions(List *connectionList);
+static PGresult * GetRemoteCommandResultSkippingClockAdjustment(
+	MultiConnection *connection, bool raiseErrors);
+static void StartRemoteTransactionBeginWithCommand(struct MultiConnection *connection,
+												   const char *command);
 
 
 static char *IsolationLevelName[] = {
@@ -73,6 +79,19 @@ static char *IsolationLevelName[] = {
  */
 void
 StartRemoteTransactionBegin(struct MultiConnection *connection)
+{
+	StartRemoteTransactionBeginWithCommand(connection, NULL);
+}
+
+
+/*
+ * StartRemoteTransactionBeginWithCommand is like StartRemoteTransactionBegin,
+ * but additionally appends the given command (if not NULL) to the BEGIN such
+ * that it runs in the remote transaction without an extra network round-trip.
+ */
+static void
+StartRemoteTransactionBeginWithCommand(struct MultiConnection *connection,
+									   const char *command)
 {
 	RemoteTransaction *transaction = &connection->remoteTransaction;
 
@@ -129,6 +148,11 @@ StartRemoteTransactionBegin(struct MultiConnection *connection)
 
 	pfree(assignDistributedTransactionIdCommand);
 
+	if (command != NULL)
+	{
+		appendStringInfoString(beginAndSetDistributedTransactionId, command);
+	}
+
 	bool success = SendRemoteCommand(connection,
 									 beginAndSetDistributedTransactionId->data);
 
@@ -380,10 +404,20 @@ StartRemoteTransactionCommit(MultiConnection *connection)
 	}
 	else
 	{
+		char *command = "COMMIT";
+
+		/* let the node adjust to the transaction clock, if any, before committing */
+		char *clockAdjustmentCommand = TransactionClockAdjustmentCommand();
+		if (clockAdjustmentCommand != NULL)
+		{
+			command = psprintf("%sCOMMIT", clockAdjustmentCommand);
+			transaction->clockAdjustmentSent = true;
+		}
+
 		/* initiate remote transaction commit */
 		transaction->transactionState = REMOTE_TRANS_1PC_COMMITTING;
 
-		if (!SendRemoteCommand(connection, "COMMIT"))
+		if (!SendRemoteCommand(connection, command))
 		{
 			/*
 			 * For a moment there I thought we were in trouble.
@@ -412,7 +446,8 @@ FinishRemoteTransactionCommit(MultiConnection *connection)
 		   transaction->transactionState == REMOTE_TRANS_1PC_COMMITTING ||
 		   transaction->transactionState == REMOTE_TRANS_2PC_COMMITTING);
 
-	PGresult *result = GetRemoteCommandResult(connection, raiseErrors);
+	PGresult *result = GetRemoteCommandResultSkippingClockAdjustment(connection,
+																	 raiseErrors);
 
 	if (!IsResponseOK(result))
 	{
@@ -468,6 +503,33 @@ RemoteTransactionCommit(MultiConnection *connection)
 }
 
 
+/*
+ * GetRemoteCommandResultSkippingClockAdjustment returns the result of the
+ * PREPARE TRANSACTION or COMMIT sent over the connection. If the transaction
+ * clock adjustment was sent in front of it, its result is skipped when it
+ * succeeded. When it failed, the PREPARE TRANSACTION or COMMIT did not run,
+ * so its error is returned instead.
+ */
+static PGresult *
+GetRemoteCommandResultSkippingClockAdjustment(MultiConnection *connection,
+											  bool raiseErrors)
+{
+	RemoteTransaction *transaction = &connection->remoteTransaction;
+
+	PGresult *result = GetRemoteCommandResult(connection, raiseErrors);
+
+	if (transaction->clockAdjustmentSent && IsResponseOK(result))
+	{
+		PQclear(result);
+		result = GetRemoteCommandResult(connection, raiseErrors);
+	}
+
+	transaction->clockAdjustmentSent = false;
+
+	return result;
+}
+
+
 /*
  * StartRemoteTransactionAbort initiates abortin the transaction in a
  * non-blocking manner.
@@ -488,8 +550,25 @@ StartRemoteTransactionAbort(MultiConnection *connection)
 	 * to wait, because a long running statement may be running, so force it to
 	 * be killed in that case.
 	 */
-	if (transaction->transactionState == REMOTE_TRANS_PREPARING ||
-		transaction->transactionState == REMOTE_TRANS_PREPARED)
+	bool prepareSent = transaction->transactionState == REMOTE_TRANS_PREPARING ||
+					   transaction->transactionState == REMOTE_TRANS_PREPARED;
+
+	if (transaction->transactionState == REMOTE_TRANS_PREPARING &&
+		transaction->clockAdjustmentSent)
+	{
+		/*
+		 * The transaction clock adjustment was sent in front of PREPARE
+		 * TRANSACTION. If it failed, PREPARE TRANSACTION did not run and the
+		 * remote transaction block is still open, so a plain ROLLBACK is
+		 * needed rather than ROLLBACK PREPARED.
+		 */
+		PGresult *result = GetRemoteCommandResultSkippingClockAdjustment(connection,
+																		 raiseErrors);
+		prepareSent = IsResponseOK(result);
+		PQclear(result);
+	}
+
+	if (prepareSent)
 	{
 		ForgetResults(connection);
 
@@ -594,6 +673,9 @@ RemoteTransactionAbort(MultiConnection *connection)
 /*
  * StartRemoteTransactionPrepare initiates preparing the transaction in a
  * non-blocking manner.
+ *
+ * The caller is responsible for logging the prepared transaction in
+ * pg_dist_transaction, see CoordinatedRemoteTransactionsPrepare.
  */
 void
 StartRemoteTransactionPrepare(struct MultiConnection *connection)
@@ -612,13 +694,6 @@ StartRemoteTransactionPrepare(struct MultiConnection *connection)
 
 	Assign2PCIdentifier(connection);
 
-	/* log transactions to workers in pg_dist_transaction */
-	WorkerNode *workerNode = FindWorkerNode(connection->hostname, connection->port);
-	if (workerNode != NULL)
-	{
-		LogTransactionRecord(workerNode->groupId, transaction->preparedName);
-	}
-
 	/*
 	 * We need to allocate 424 bytes for command buffer (including '\0'):
 	 *  - len("PREPARE TRANSACTION ") = 20
@@ -629,7 +704,17 @@ StartRemoteTransactionPrepare(struct MultiConnection *connection)
 	SafeSnprintf(command, sizeof(command), "PREPARE TRANSACTION %s", quotedPrepName);
 	pfree(quotedPrepName);
 
-	if (!SendRemoteCommand(connection, command))
+	char *commandToSend = command;
+
+	/* let the node adjust to the transaction clock, if any, before preparing */
+	char *clockAdjustmentCommand = TransactionClockAdjustmentCommand();
+	if (clockAdjustmentCommand != NULL)
+	{
+		commandToSend = psprintf("%s%s", clockAdjustmentCommand, command);
+		transaction->clockAdjustmentSent = true;
+	}
+
+	if (!SendRemoteCommand(connection, commandToSend))
 	{
 		HandleRemoteTransactionConnectionError(connection, raiseErrors);
 	}
@@ -653,7 +738,8 @@ FinishRemoteTransactionPrepare(struct MultiConnection *connection)
 
 	Assert(transaction->transactionState == REMOTE_TRANS_PREPARING);
 
-	PGresult *result = GetRemoteCommandResult(connection, raiseErrors);
+	PGresult *result = GetRemoteCommandResultSkippingClockAdjustment(connection,
+																	 raiseErrors);
 
 	if (!IsResponseOK(result))
 	{
@@ -702,6 +788,50 @@ RemoteTransactionBeginIfNecessary(MultiConnection *connection)
 }
 
 
+/*
+ * RemoteTransactionBeginAndExecuteCriticalCommand executes a command that is
+ * critical to the transaction over the given connection, beginning the remote
+ * transaction first if necessary. When the remote transaction has not started
+ * yet, the command is sent along with the BEGIN, which saves a round-trip for
+ * commands such as the remote lock acquisition for replicated tables. If the
+ * command fails then the transaction aborts.
+ */
+void
+RemoteTransactionBeginAndExecuteCriticalCommand(MultiConnection *connection,
+												const char *command)
+{
+	RemoteTransaction *transaction = &connection->remoteTransaction;
+
+	if (!InCoordinatedTransaction() ||
+		transaction->transactionState != REMOTE_TRANS_NOT_STARTED)
+	{
+		ExecuteCriticalRemoteCommand(connection, command);
+		return;
+	}
+
+	/* can't send BEGIN if a command already is in progress */
+	Assert(PQtransactionStatus(connection->pgConn) != PQTRANS_ACTIVE);
+
+	StartRemoteTransactionBeginWithCommand(connection, command);
+
+	/* the first failing statement, if any, aborts the transaction */
+	bool raiseInterrupts = true;
+	PGresult *result = NULL;
+	while ((result = GetRemoteCommandResult(connection, raiseInterrupts)) != NULL)
+	{
+		if (!IsResponseOK(result))
+		{
+			ReportResultError(connection, result, ERROR);
+		}
+
+		PQclear(result);
+	}
+
+	transaction->transactionState = REMOTE_TRANS_STARTED;
+	transaction->lastSuccessfulSubXact = transaction->lastQueuedSubXact;
+}
+
+
 /*
  * RemoteTransactionsBeginIfNecessary begins, if necessary according to this
  * session's coordinated transaction state, and the remote transaction's
@@ -924,6 +1054,14 @@ CoordinatedRemoteTransactionsPrepare(void)
 		}
 	}
 
+	/*
+	 * Log the transactions to workers in pg_dist_transaction while the workers
+	 * are preparing. The records only become visible to recovery once the local
+	 * transaction commits, which happens after all PREPAREs succeeded, so it
+	 * does not matter that they are written after sending PREPARE.
+	 */
+	LogPreparedTransactions(connectionList);
+
 	bool raiseInterrupts = true;
 	WaitForAllConnections(connectionList, raiseInterrupts);
 
@@ -954,6 +1092,42 @@ CoordinatedRemoteTransactionsPrepare(void)
 }
 
 
+/*
+ * LogPreparedTransactions writes a pg_dist_transaction record for each of the
+ * given connections on which PREPARE TRANSACTION was sent.
+ */
+static void
+LogPreparedTransactions(List *connectionList)
+{
+	List *groupIdList = NIL;
+	List *transactionNameList = NIL;
+
+	MultiConnection *connection = NULL;
+	foreach_ptr(connection, connectionList)
+	{
+		RemoteTransaction *transaction = &connection->remoteTransaction;
+
+		if (transaction->transactionState != REMOTE_TRANS_PREPARING)
+		{
+			continue;
+		}
+
+		WorkerNode *workerNode = FindWorkerNode(connection->hostname, connection->port);
+		if (workerNode != NULL)
+		{
+			groupIdList = lappend_int(groupIdList, workerNode->groupId);
+			transactionNameList = lappend(transactionNameList,
+										  transaction->preparedName);
+		}
+	}
+
+	LogTransactionRecordList(groupIdList, transactionNameList);
+
+	list_free(groupIdList);
+	list_free(transactionNameList);
+}
+
+
 /*
  * CoordinatedRemoteTransactionsCommit performs distributed transactions
  * handling at commit time. This will be called at XACT_EVENT_PRE_COMMIT if
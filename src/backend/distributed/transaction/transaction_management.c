@@ -22,6 +22,7 @@
 #include "catalog/dependency.h"
 #include "common/hashfn.h"
 #include "distributed/backend_data.h"
+#include "distributed/causal_clock.h"
 #include "distributed/citus_safe_lib.h"
 #include "distributed/connection_management.h"
 #include "distributed/distributed_planner.h"
@@ -70,6 +71,12 @@ bool AllModificationsCommutative = false;
 /* we've deprecated this flag, keeping here for some time not to break existing users */
 bool EnableDeadlockPrevention = true;
 
+/*
+ * GUC that determines whether to commit without 2PC when only a single remote
+ * transaction did writes and nothing was written locally.
+ */
+bool Skip2PCForSingleNodeTransactions = false;
+
 /* number of nested stored procedure call levels we are currently in */
 int StoredProcedureLevel = 0;
 
@@ -160,6 +167,7 @@ static void PopSubXact(SubTransactionId subId, bool commit);
 static void ResetGlobalVariables(void);
 static bool SwallowErrors(void (*func)(void));
 static void ForceAllInProgressConnectionsToClose(void);
+static bool CoordinatedTransactionHasSingleWriter(void);
 static void EnsurePrepareTransactionIsAllowed(void);
 static HTAB * CurrentTransactionPropagatedObjects(bool readonly);
 static HTAB * ParentTransactionPropagatedObjects(bool readonly);
@@ -517,6 +525,22 @@ CoordinatedTransactionCallback(XactEvent event, void *arg)
 			 * fails, which can lead to divergence when not using 2PC.
 			 */
 
+			if (ShouldCoordinatedTransactionUse2PC &&
+				Skip2PCForSingleNodeTransactions &&
+				CoordinatedTransactionHasSingleWriter())
+			{
+				/*
+				 * With a single participant that did writes, committing it
+				 * directly is atomic by itself, so save the PREPARE and COMMIT
+				 * PREPARED round trips.
+				 */
+				ereport(DEBUG2, (errmsg("skipping two-phase commit since only a "
+										"single remote transaction did "
+										"modifications")));
+
+				ShouldCoordinatedTransactionUse2PC = false;
+			}
+
 			if (ShouldCoordinatedTransactionUse2PC)
 			{
 				CoordinatedRemoteTransactionsPrepare();
@@ -578,6 +602,49 @@ ForceAllInProgressConnectionsToClose(void)
 }
 
 
+/*
+ * CoordinatedTransactionHasSingleWriter returns true if exactly one of the remote
+ * transactions did modifications, and the local transaction did not write
+ * anything. This is for instance the case for a multi-shard modification whose
+ * shards all live on one worker and that used a single connection, or for a
+ * transaction block that did several single-shard writes to the same worker.
+ *
+ * If the local transaction has an xid, it may have written to local shards or to
+ * the Citus metadata. These writes are committed after the remote transactions
+ * are committed in XACT_EVENT_PRE_COMMIT, so we still need 2PC for atomicity.
+ */
+static bool
+CoordinatedTransactionHasSingleWriter(void)
+{
+	int writerCount = 0;
+
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+	{
+		return false;
+	}
+
+	dlist_iter iter;
+	dlist_foreach(iter, &InProgressTransactions)
+	{
+		MultiConnection *connection = dlist_container(MultiConnection,
+													  transactionNode,
+													  iter.cur);
+
+		if (ConnectionModifiedPlacement(connection))
+		{
+			writerCount++;
+		}
+
+		if (writerCount > 1)
+		{
+			return false;
+		}
+	}
+
+	return writerCount == 1;
+}
+
+
 /*
  * If an ERROR is thrown while processing a transaction the ABORT handler is called.
  * ERRORS thrown during ABORT are not treated any differently, the ABORT handler is also
@@ -644,6 +711,7 @@ ResetGlobalVariables()
 	BeginXactReadOnly = BeginXactReadOnly_NotSet;
 	BeginXactDeferrable = BeginXactDeferrable_NotSet;
 	ResetWorkerErrorIndication();
+	ResetTransactionClock();
 	memset(&AllowedDistributionColumnValue, 0,
 		   sizeof(AllowedDistributionColumn));
 }
@@ -51,9 +51,34 @@
 PG_FUNCTION_INFO_V1(recover_prepared_transactions);
 
 
+/*
+ * WorkerRecoveryState keeps track of the recovery of the prepared transactions
+ * on a single worker in RecoverTwoPhaseCommits.
+ */
+typedef struct WorkerRecoveryState
+{
+	WorkerNode *workerNode;
+	MultiConnection *connection;
+
+	/* prepared transactions before and after the pg_dist_transaction snapshot */
+	HTAB *pendingTransactionSet;
+	HTAB *recheckTransactionSet;
+
+	/*
+	 * Whether fetching the prepared transactions from the worker, or
+	 * committing one of them, failed.
+	 */
+	bool recoveryFailed;
+} WorkerRecoveryState;
+
+
 /* Local functions forward declarations */
-static int RecoverWorkerTransactions(WorkerNode *workerNode);
-static List * PendingWorkerTransactionList(MultiConnection *connection);
+static List * OpenWorkerRecoveryConnections(List *workerList);
+static WorkerRecoveryState * WorkerRecoveryStateForGroup(List *recoveryStateList,
+														 int32 groupId);
+static void FetchPendingWorkerTransactions(List *recoveryStateList, bool recheck);
+static int AbortPendingWorkerTransactions(WorkerRecoveryState *recoveryState,
+										  HTAB *activeTransactionNumberSet);
 static bool IsTransactionInProgress(HTAB *activeTransactionNumberSet,
 									char *preparedTransactionName);
 static bool RecoverPreparedTransactionOnWorker(MultiConnection *connection,
@@ -76,31 +101,54 @@ recover_prepared_transactions(PG_FUNCTION_ARGS)
 
 
 /*
- * LogTransactionRecord registers the fact that a transaction has been
- * prepared on a worker. The presence of this record indicates that the
- * prepared transaction should be committed.
+ * LogTransactionRecordList registers the fact that transactions have been
+ * prepared on workers. The presence of these records indicates that the
+ * prepared transactions should be committed. The i-th transaction name in
+ * transactionNameList belongs to the i-th group in groupIdList. Writing all
+ * records of a distributed transaction in one go avoids opening the catalog
+ * and its indexes, and incrementing the command counter, once per participant.
  */
 void
-LogTransactionRecord(int32 groupId, char *transactionName)
+LogTransactionRecordList(List *groupIdList, List *transactionNameList)
 {
 	Datum values[Natts_pg_dist_transaction];
 	bool isNulls[Natts_pg_dist_transaction];
 
-	/* form new transaction tuple */
-	memset(values, 0, sizeof(values));
-	memset(isNulls, false, sizeof(isNulls));
+	Assert(list_length(groupIdList) == list_length(transactionNameList));
 
-	values[Anum_pg_dist_transaction_groupid - 1] = Int32GetDatum(groupId);
-	values[Anum_pg_dist_transaction_gid - 1] = CStringGetTextDatum(transactionName);
+	if (groupIdList == NIL)
+	{
+		return;
+	}
 
-	/* open transaction relation and insert new tuple */
+	/* open transaction relation and its indexes */
 	Relation pgDistTransaction = table_open(DistTransactionRelationId(),
 											RowExclusiveLock);
-
 	TupleDesc tupleDescriptor = RelationGetDescr(pgDistTransaction);
-	HeapTuple heapTuple = heap_form_tuple(tupleDescriptor, values, isNulls);
+	CatalogIndexState indexState = CatalogOpenIndexes(pgDistTransaction);
+
+	ListCell *groupIdCell = NULL;
+	ListCell *transactionNameCell = NULL;
+	forboth(groupIdCell, groupIdList, transactionNameCell, transactionNameList)
+	{
+		int32 groupId = lfirst_int(groupIdCell);
+		char *transactionName = (char *) lfirst(transactionNameCell);
+
+		/* form new transaction tuple */
+		memset(values, 0, sizeof(values));
+		memset(isNulls, false, sizeof(isNulls));
+
+		values[Anum_pg_dist_transaction_groupid - 1] = Int32GetDatum(groupId);
+		values[Anum_pg_dist_transaction_gid - 1] = CStringGetTextDatum(transactionName);
+
+		HeapTuple heapTuple = heap_form_tuple(tupleDescriptor, values, isNulls);
+
+		CatalogTupleInsertWithInfo(pgDistTransaction, heapTuple, indexState);
+
+		heap_freetuple(heapTuple);
+	}
 
-	CatalogTupleInsert(pgDistTransaction, heapTuple);
+	CatalogCloseIndexes(indexState);
 
 	CommandCounterIncrement();
 
@@ -112,73 +160,33 @@ LogTransactionRecord(int32 groupId, char *transactionName)
 /*
  * RecoverTwoPhaseCommits recovers any pending prepared
  * transactions started by this node on other nodes.
+ *
+ * The remote round trips that observe the prepared transactions are done
+ * against all workers in parallel, such that the time spent in recovery does
+ * not grow with the number of workers.
  */
 int
 RecoverTwoPhaseCommits(void)
 {
 	int recoveredTransactionCount = 0;
+	HeapTuple heapTuple = NULL;
 
 	/* take advisory lock first to avoid running concurrently */
 	LockTransactionRecovery(ShareUpdateExclusiveLock);
 
-	List *workerList = ActivePrimaryNodeList(NoLock);
-	WorkerNode *workerNode = NULL;
-	foreach_ptr(workerNode, workerList)
-	{
-		recoveredTransactionCount += RecoverWorkerTransactions(workerNode);
-	}
-
-	return recoveredTransactionCount;
-}
-
-
-/*
- * RecoverWorkerTransactions recovers any pending prepared transactions
- * started by this node on the specified worker.
- */
-static int
-RecoverWorkerTransactions(WorkerNode *workerNode)
-{
-	int recoveredTransactionCount = 0;
-
-	int32 groupId = workerNode->groupId;
-	char *nodeName = workerNode->workerName;
-	int nodePort = workerNode->workerPort;
-
-
-	ScanKeyData scanKey[1];
-	int scanKeyCount = 1;
-	bool indexOK = true;
-	HeapTuple heapTuple = NULL;
-
-	HASH_SEQ_STATUS status;
-
-	bool recoveryFailed = false;
-
-	int connectionFlags = 0;
-	MultiConnection *connection = GetNodeConnection(connectionFlags, nodeName, nodePort);
-	if (connection->pgConn == NULL || PQstatus(connection->pgConn) != CONNECTION_OK)
-	{
-		ereport(WARNING, (errmsg("transaction recovery cannot connect to %s:%d",
-								 nodeName, nodePort)));
-
-		return 0;
-	}
-
 	MemoryContext localContext = AllocSetContextCreateInternal(CurrentMemoryContext,
-															   "RecoverWorkerTransactions",
+															   "RecoverTwoPhaseCommits",
 															   ALLOCSET_DEFAULT_MINSIZE,
 															   ALLOCSET_DEFAULT_INITSIZE,
 															   ALLOCSET_DEFAULT_MAXSIZE);
 
 	MemoryContext oldContext = MemoryContextSwitchTo(localContext);
 
-	Relation pgDistTransaction = table_open(DistTransactionRelationId(),
-											RowExclusiveLock);
-	TupleDesc tupleDescriptor = RelationGetDescr(pgDistTransaction);
+	List *workerList = ActivePrimaryNodeList(NoLock);
+	List *recoveryStateList = OpenWorkerRecoveryConnections(workerList);
 
 	/*
-	 * We're going to check the list of prepared transactions on the worker,
+	 * We're going to check the list of prepared transactions on the workers,
 	 * but some of those prepared transactions might belong to ongoing
 	 * distributed transactions.
 	 *
@@ -188,10 +196,10 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 	 * by consulting the list of active distributed transactions, and follow
 	 * a carefully chosen order to avoid race conditions:
 	 *
-	 * 1) P = prepared transactions on worker
+	 * 1) P = prepared transactions on workers
 	 * 2) A = active distributed transactions
 	 * 3) T = pg_dist_transaction snapshot
-	 * 4) Q = prepared transactions on worker
+	 * 4) Q = prepared transactions on workers
 	 *
 	 * By observing A after P, we get a conclusive answer to which distributed
 	 * transactions we observed in P are still in progress. It is safe to recover
@@ -207,32 +215,32 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 	 * We therefore observe the set of prepared transactions one more time in
 	 * step 4. The aforementioned transactions would show up in Q, but not in
 	 * P. We can skip those transactions and recover them later.
+	 *
+	 * Each step is done for all workers before moving on to the next step,
+	 * which preserves the order for every individual worker.
 	 */
 
-	/* find stale prepared transactions on the remote node */
-	List *pendingTransactionList = PendingWorkerTransactionList(connection);
-	HTAB *pendingTransactionSet = ListToHashSet(pendingTransactionList, NAMEDATALEN,
-												true);
+	/* find stale prepared transactions on the remote nodes */
+	bool recheck = false;
+	FetchPendingWorkerTransactions(recoveryStateList, recheck);
 
 	/* find in-progress distributed transactions */
 	List *activeTransactionNumberList = ActiveDistributedTransactionNumbers();
 	HTAB *activeTransactionNumberSet = ListToHashSet(activeTransactionNumberList,
 													 sizeof(uint64), false);
 
-	/* scan through all recovery records of the current worker */
-	ScanKeyInit(&scanKey[0], Anum_pg_dist_transaction_groupid,
-				BTEqualStrategyNumber, F_INT4EQ, Int32GetDatum(groupId));
+	Relation pgDistTransaction = table_open(DistTransactionRelationId(),
+											RowExclusiveLock);
+	TupleDesc tupleDescriptor = RelationGetDescr(pgDistTransaction);
 
 	/* get a snapshot of pg_dist_transaction */
-	SysScanDesc scanDescriptor = systable_beginscan(pgDistTransaction,
-													DistTransactionGroupIndexId(),
-													indexOK,
-													NULL, scanKeyCount, scanKey);
+	bool indexOK = false;
+	SysScanDesc scanDescriptor = systable_beginscan(pgDistTransaction, InvalidOid,
+													indexOK, NULL, 0, NULL);
 
-	/* find stale prepared transactions on the remote node */
-	List *recheckTransactionList = PendingWorkerTransactionList(connection);
-	HTAB *recheckTransactionSet = ListToHashSet(recheckTransactionList, NAMEDATALEN,
-												true);
+	/* find stale prepared transactions on the remote nodes once more */
+	recheck = true;
+	FetchPendingWorkerTransactions(recoveryStateList, recheck);
 
 	while (HeapTupleIsValid(heapTuple = systable_getnext(scanDescriptor)))
 	{
@@ -240,6 +248,21 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 		bool foundPreparedTransactionBeforeCommit = false;
 		bool foundPreparedTransactionAfterCommit = false;
 
+		Datum groupIdDatum = heap_getattr(heapTuple, Anum_pg_dist_transaction_groupid,
+										  tupleDescriptor, &isNull);
+		WorkerRecoveryState *recoveryState =
+			WorkerRecoveryStateForGroup(recoveryStateList, DatumGetInt32(groupIdDatum));
+		if (recoveryState == NULL || recoveryState->recoveryFailed)
+		{
+			/*
+			 * The worker is not an active primary, we could not connect to it,
+			 * we could not fetch its prepared transactions, or we failed to
+			 * recover one of its transactions. Leave its records
+			 * for the next call to recover_prepared_transactions.
+			 */
+			continue;
+		}
+
 		Datum transactionNameDatum = heap_getattr(heapTuple,
 												  Anum_pg_dist_transaction_gid,
 												  tupleDescriptor, &isNull);
@@ -261,10 +284,10 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 		 * Remove the transaction from the pending list such that only transactions
 		 * that need to be aborted remain at the end.
 		 */
-		hash_search(pendingTransactionSet, transactionName, HASH_REMOVE,
+		hash_search(recoveryState->pendingTransactionSet, transactionName, HASH_REMOVE,
 					&foundPreparedTransactionBeforeCommit);
 
-		hash_search(recheckTransactionSet, transactionName, HASH_FIND,
+		hash_search(recoveryState->recheckTransactionSet, transactionName, HASH_FIND,
 					&foundPreparedTransactionAfterCommit);
 
 		if (foundPreparedTransactionBeforeCommit && foundPreparedTransactionAfterCommit)
@@ -278,18 +301,17 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 			 * observed a prepared transaction that was committed immediately after.
 			 */
 			bool shouldCommit = true;
-			bool commitSucceeded = RecoverPreparedTransactionOnWorker(connection,
-																	  transactionName,
-																	  shouldCommit);
+			bool commitSucceeded = RecoverPreparedTransactionOnWorker(
+				recoveryState->connection, transactionName, shouldCommit);
 			if (!commitSucceeded)
 			{
 				/*
-				 * Failed to commit on the current worker. Stop without throwing
-				 * an error to allow recover_prepared_transactions to continue with
-				 * other workers.
+				 * Failed to commit on the current worker. Stop recovering this
+				 * worker without throwing an error to allow
+				 * recover_prepared_transactions to continue with other workers.
 				 */
-				recoveryFailed = true;
-				break;
+				recoveryState->recoveryFailed = true;
+				continue;
 			}
 
 			recoveredTransactionCount++;
@@ -348,39 +370,14 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 	systable_endscan(scanDescriptor);
 	table_close(pgDistTransaction, NoLock);
 
-	if (!recoveryFailed)
+	WorkerRecoveryState *recoveryState = NULL;
+	foreach_ptr(recoveryState, recoveryStateList)
 	{
-		char *pendingTransactionName = NULL;
-		bool abortSucceeded = true;
-
-		/*
-		 * All remaining prepared transactions that are not part of an in-progress
-		 * distributed transaction should be aborted since we did not find a recovery
-		 * record, which implies the disributed transaction aborted.
-		 */
-		hash_seq_init(&status, pendingTransactionSet);
-
-		while ((pendingTransactionName = hash_seq_search(&status)) != NULL)
+		if (!recoveryState->recoveryFailed)
 		{
-			bool isTransactionInProgress = IsTransactionInProgress(
-				activeTransactionNumberSet,
-				pendingTransactionName);
-			if (isTransactionInProgress)
-			{
-				continue;
-			}
-
-			bool shouldCommit = false;
-			abortSucceeded = RecoverPreparedTransactionOnWorker(connection,
-																pendingTransactionName,
-																shouldCommit);
-			if (!abortSucceeded)
-			{
-				hash_seq_term(&status);
-				break;
-			}
-
-			recoveredTransactionCount++;
+			recoveredTransactionCount +=
+				AbortPendingWorkerTransactions(recoveryState,
+											   activeTransactionNumberSet);
 		}
 	}
 
@@ -392,47 +389,194 @@ RecoverWorkerTransactions(WorkerNode *workerNode)
 
 
 /*
- * PendingWorkerTransactionList returns a list of pending prepared
- * transactions on a remote node that were started by this node.
+ * OpenWorkerRecoveryConnections establishes connections to the given workers in
+ * parallel and returns a WorkerRecoveryState for each worker that we could
+ * connect to.
  */
 static List *
-PendingWorkerTransactionList(MultiConnection *connection)
+OpenWorkerRecoveryConnections(List *workerList)
+{
+	List *connectionList = NIL;
+	List *recoveryStateList = NIL;
+	int connectionFlags = 0;
+
+	WorkerNode *workerNode = NULL;
+	foreach_ptr(workerNode, workerList)
+	{
+		MultiConnection *connection = StartNodeConnection(connectionFlags,
+														  workerNode->workerName,
+														  workerNode->workerPort);
+		connectionList = lappend(connectionList, connection);
+	}
+
+	FinishConnectionListEstablishment(connectionList);
+
+	MultiConnection *connection = NULL;
+	forboth_ptr(workerNode, workerList, connection, connectionList)
+	{
+		if (connection->pgConn == NULL || PQstatus(connection->pgConn) != CONNECTION_OK)
+		{
+			ereport(WARNING, (errmsg("transaction recovery cannot connect to %s:%d",
+									 workerNode->workerName,
+									 workerNode->workerPort)));
+			continue;
+		}
+
+		WorkerRecoveryState *recoveryState = palloc0(sizeof(WorkerRecoveryState));
+		recoveryState->workerNode = workerNode;
+		recoveryState->connection = connection;
+
+		recoveryStateList = lappend(recoveryStateList, recoveryState);
+	}
+
+	return recoveryStateList;
+}
+
+
+/*
+ * WorkerRecoveryStateForGroup returns the WorkerRecoveryState of the worker in
+ * the given group, or NULL if there is none.
+ */
+static WorkerRecoveryState *
+WorkerRecoveryStateForGroup(List *recoveryStateList, int32 groupId)
+{
+	WorkerRecoveryState *recoveryState = NULL;
+	foreach_ptr(recoveryState, recoveryStateList)
+	{
+		if (recoveryState->workerNode->groupId == groupId)
+		{
+			return recoveryState;
+		}
+	}
+
+	return NULL;
+}
+
+
+/*
+ * FetchPendingWorkerTransactions fetches the pending prepared transactions that
+ * were started by this node from all workers in the given list in parallel. The
+ * result is stored in the pendingTransactionSet of each worker, or in its
+ * recheckTransactionSet if recheck is true.
+ *
+ * If the transactions cannot be fetched from a worker, we emit a warning and
+ * mark the worker as failed, such that recovery continues with the other
+ * workers. Failed workers are skipped.
+ */
+static void
+FetchPendingWorkerTransactions(List *recoveryStateList, bool recheck)
 {
 	StringInfo command = makeStringInfo();
 	bool raiseInterrupts = true;
-	List *transactionNames = NIL;
 	int32 coordinatorId = GetLocalGroupId();
 
 	appendStringInfo(command, "SELECT gid FROM pg_prepared_xacts "
 							  "WHERE gid LIKE 'citus\\_%d\\_%%' and database = current_database()",
 					 coordinatorId);
 
-	int querySent = SendRemoteCommand(connection, command->data);
-	if (querySent == 0)
+	WorkerRecoveryState *recoveryState = NULL;
+	foreach_ptr(recoveryState, recoveryStateList)
 	{
-		ReportConnectionError(connection, ERROR);
+		if (recoveryState->recoveryFailed)
+		{
+			continue;
+		}
+
+		int querySent = SendRemoteCommand(recoveryState->connection, command->data);
+		if (querySent == 0)
+		{
+			ReportConnectionError(recoveryState->connection, WARNING);
+			recoveryState->recoveryFailed = true;
+		}
 	}
 
-	PGresult *result = GetRemoteCommandResult(connection, raiseInterrupts);
-	if (!IsResponseOK(result))
+	foreach_ptr(recoveryState, recoveryStateList)
 	{
-		ReportResultError(connection, result, ERROR);
+		MultiConnection *connection = recoveryState->connection;
+		List *transactionNames = NIL;
+
+		if (recoveryState->recoveryFailed)
+		{
+			continue;
+		}
+
+		PGresult *result = GetRemoteCommandResult(connection, raiseInterrupts);
+		if (!IsResponseOK(result))
+		{
+			ReportResultError(connection, result, WARNING);
+			PQclear(result);
+			ForgetResults(connection);
+
+			recoveryState->recoveryFailed = true;
+			continue;
+		}
+
+		int rowCount = PQntuples(result);
+
+		for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+		{
+			const int columnIndex = 0;
+			char *transactionName = PQgetvalue(result, rowIndex, columnIndex);
+
+			transactionNames = lappend(transactionNames, pstrdup(transactionName));
+		}
+
+		PQclear(result);
+		ForgetResults(connection);
+
+		HTAB *transactionSet = ListToHashSet(transactionNames, NAMEDATALEN, true);
+		if (recheck)
+		{
+			recoveryState->recheckTransactionSet = transactionSet;
+		}
+		else
+		{
+			recoveryState->pendingTransactionSet = transactionSet;
+		}
 	}
+}
+
+
+/*
+ * AbortPendingWorkerTransactions aborts all prepared transactions that remain in
+ * the pending set of the given worker after processing the recovery records and
+ * are not part of an in-progress distributed transaction, since we did not find
+ * a recovery record for them, which implies the distributed transaction aborted.
+ * The function returns the number of aborted transactions.
+ */
+static int
+AbortPendingWorkerTransactions(WorkerRecoveryState *recoveryState,
+							   HTAB *activeTransactionNumberSet)
+{
+	int abortedTransactionCount = 0;
+	char *pendingTransactionName = NULL;
+	HASH_SEQ_STATUS status;
 
-	int rowCount = PQntuples(result);
+	hash_seq_init(&status, recoveryState->pendingTransactionSet);
 
-	for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+	while ((pendingTransactionName = hash_seq_search(&status)) != NULL)
 	{
-		const int columnIndex = 0;
-		char *transactionName = PQgetvalue(result, rowIndex, columnIndex);
+		bool isTransactionInProgress = IsTransactionInProgress(
+			activeTransactionNumberSet,
+			pendingTransactionName);
+		if (isTransactionInProgress)
+		{
+			continue;
+		}
 
-		transactionNames = lappend(transactionNames, pstrdup(transactionName));
-	}
+		bool shouldCommit = false;
+		bool abortSucceeded = RecoverPreparedTransactionOnWorker(
+			recoveryState->connection, pendingTransactionName, shouldCommit);
+		if (!abortSucceeded)
+		{
+			hash_seq_term(&status);
+			break;
+		}
 
-	PQclear(result);
-	ForgetResults(connection);
+		abortedTransactionCount++;
+	}
 
-	return transactionNames;
+	return abortedTransactionCount;
 }
 
 
@@ -99,8 +99,7 @@ SendCommandToWorkerAsUser(const char *nodeName, int32 nodePort, const char *node
 		nodeUser, NULL);
 
 	MarkRemoteTransactionCritical(transactionConnection);
-	RemoteTransactionBeginIfNecessary(transactionConnection);
-	ExecuteCriticalRemoteCommand(transactionConnection, command);
+	RemoteTransactionBeginAndExecuteCriticalCommand(transactionConnection, command);
 }
 
 
@@ -138,15 +137,27 @@ SendCommandToWorkersWithMetadataViaSuperUser(const char *command)
 /*
  * SendCommandListToWorkersWithMetadata sends all commands to all metadata workers
  * with the current user. See `SendCommandToWorkersWithMetadata`for details.
+ *
+ * The commands are sent as a single multi-statement string, such that we have
+ * one round trip per node instead of one per command.
  */
 void
 SendCommandListToWorkersWithMetadata(List *commands)
 {
-	char *command = NULL;
-	foreach_ptr(command, commands)
+	if (list_length(commands) == 0)
 	{
-		SendCommandToWorkersWithMetadata(command);
+		/* nothing to do */
+		return;
 	}
+
+	/*
+	 * If there is only a single command, avoid additional call to
+	 * StringJoin given that some strings can be quite large.
+	 */
+	char *stringToSend = (list_length(commands) == 1) ?
+						 linitial(commands) : StringJoin(commands, ';');
+
+	SendCommandToWorkersWithMetadata(stringToSend);
 }
 
 
@@ -187,10 +198,14 @@ TargetWorkerSetNodeList(TargetWorkerSet targetWorkerSet, LOCKMODE lockMode)
 
 /*
  * SendBareCommandListToMetadataWorkers sends a list of commands to metadata
- * workers in serial. Commands are committed immediately: new connections are
- * always used and no transaction block is used (hence "bare"). The connections
- * are made as the extension owner to ensure write access to the Citus metadata
- * tables. Primarly useful for INDEX commands using CONCURRENTLY.
+ * workers. Commands are committed immediately: new connections are always used
+ * and no transaction block is used (hence "bare"). The connections are made as
+ * the extension owner to ensure write access to the Citus metadata tables.
+ * Primarly useful for INDEX commands using CONCURRENTLY.
+ *
+ * The commands cannot be combined into a single multi-statement string, since
+ * that would run them in an implicit transaction block. Still, each command is
+ * sent to all the workers in parallel, and only then we wait for the results.
  */
 void
 SendBareCommandListToMetadataWorkers(List *commandList)
@@ -201,7 +216,9 @@ SendBareCommandListToMetadataWorkers(List *commandList)
 
 	ErrorIfAnyMetadataNodeOutOfSync(workerNodeList);
 
-	/* run commands serially */
+	List *connectionList = NIL;
+
+	/* open connections in parallel */
 	WorkerNode *workerNode = NULL;
 	foreach_ptr(workerNode, workerNodeList)
 	{
@@ -209,18 +226,52 @@ SendBareCommandListToMetadataWorkers(List *commandList)
 		int nodePort = workerNode->workerPort;
 		int connectionFlags = FORCE_NEW_CONNECTION;
 
-		MultiConnection *workerConnection = GetNodeUserDatabaseConnection(connectionFlags,
-																		  nodeName,
-																		  nodePort,
-																		  nodeUser, NULL);
+		MultiConnection *workerConnection =
+			StartNodeUserDatabaseConnection(connectionFlags, nodeName, nodePort,
+											nodeUser, NULL);
+		connectionList = lappend(connectionList, workerConnection);
+	}
+
+	FinishConnectionListEstablishment(connectionList);
 
-		/* iterate over the commands and execute them in the same connection */
-		const char *commandString = NULL;
-		foreach_ptr(commandString, commandList)
+	/* run the commands one after the other, but on all the workers at once */
+	const char *commandString = NULL;
+	foreach_ptr(commandString, commandList)
+	{
+		MultiConnection *workerConnection = NULL;
+		foreach_ptr(workerConnection, connectionList)
 		{
-			ExecuteCriticalRemoteCommand(workerConnection, commandString);
+			int querySent = SendRemoteCommand(workerConnection, commandString);
+			if (querySent == 0)
+			{
+				ReportConnectionError(workerConnection, ERROR);
+			}
 		}
 
+		/*
+		 * The connections are not part of a coordinated transaction, so a failed
+		 * command would only be reported as a warning by ClearResults(). Error
+		 * out on any failure instead, as the command did not take effect on that
+		 * worker.
+		 */
+		bool raiseInterrupts = true;
+		foreach_ptr(workerConnection, connectionList)
+		{
+			PGresult *result = GetRemoteCommandResult(workerConnection,
+													  raiseInterrupts);
+			if (!IsResponseOK(result))
+			{
+				ReportResultError(workerConnection, result, ERROR);
+			}
+
+			PQclear(result);
+			ForgetResults(workerConnection);
+		}
+	}
+
+	MultiConnection *workerConnection = NULL;
+	foreach_ptr(workerConnection, connectionList)
+	{
 		CloseConnection(workerConnection);
 	}
 }
@@ -318,7 +369,20 @@ SendCommandToWorkersParamsInternal(TargetWorkerSet targetWorkerSet, const char *
 
 		PQclear(result);
 
-		ForgetResults(connection);
+		/*
+		 * The command may consist of multiple statements, for instance when it
+		 * comes from SendCommandListToWorkersWithMetadata(), so check the results
+		 * of the remaining statements as well.
+		 */
+		while ((result = GetRemoteCommandResult(connection, true)) != NULL)
+		{
+			if (!IsResponseOK(result))
+			{
+				ReportResultError(connection, result, ERROR);
+			}
+
+			PQclear(result);
+		}
 	}
 }
 
@@ -75,11 +75,15 @@ static TenantStats * CreateTenantStats(MultiTenantMonitor *monitor, TimestampTz
 static void FillTenantStatsHashKey(TenantStatsHashKey *key, char *tenantAttribute, uint32
 								   colocationGroupId);
 static TenantStats * FindTenantStats(MultiTenantMonitor *monitor);
+static void EnsureTenantWithinCpuLimit(MultiTenantMonitor *monitor,
+									   TenantStatsHashKey *key,
+									   TimestampTz queryTime);
 static size_t MultiTenantMonitorshmemSize(void);
 static char * ExtractTopComment(const char *inputString);
 static char * EscapeCommentChars(const char *str);
 static char * UnescapeCommentChars(const char *str);
 
+double StatTenantsCpuLimit = 0;
 int StatTenantsLogLevel = CITUS_LOG_LEVEL_OFF;
 int StatTenantsPeriod = (time_t) 60;
 int StatTenantsLimit = 100;
@@ -293,6 +297,12 @@ AttributeTask(char *tenantId, int colocationId, CmdType commandType)
 
 	LWLockRelease(&monitor->lock);
 
+	/* reject the query before it runs if the tenant used up its CPU time */
+	if (found && StatTenantsCpuLimit > 0)
+	{
+		EnsureTenantWithinCpuLimit(monitor, &key, GetCurrentTimestamp());
+	}
+
 	/* If the tenant is not found in the hash table, we will track the query with a probability of StatTenantsSampleRateForNewTenants. */
 	if (!found)
 	{
@@ -829,6 +839,53 @@ FindTenantStats(MultiTenantMonitor *monitor)
 }
 
 
+/*
+ * EnsureTenantWithinCpuLimit errors out if the tenant with the given key used
+ * more than citus.stat_tenants_cpu_limit seconds of CPU time in the current
+ * period. CPU usage recorded in an earlier period does not count, so the
+ * tenant is admitted again once the next period starts.
+ */
+static void
+EnsureTenantWithinCpuLimit(MultiTenantMonitor *monitor, TenantStatsHashKey *key,
+						   TimestampTz queryTime)
+{
+	long long int periodInMicroSeconds = StatTenantsPeriod * USECS_PER_SEC;
+	TimestampTz periodStart = queryTime - (queryTime % periodInMicroSeconds);
+	double cpuUsageInThisPeriod = 0;
+
+	LWLockAcquire(&monitor->lock, LW_SHARED);
+
+	TenantStats *tenantStats = (TenantStats *) hash_search(monitor->tenants, key,
+														   HASH_FIND, NULL);
+	if (tenantStats != NULL)
+	{
+		SpinLockAcquire(&tenantStats->lock);
+
+		if (tenantStats->lastQueryTime >= periodStart)
+		{
+			cpuUsageInThisPeriod = tenantStats->cpuUsageInThisPeriod;
+		}
+
+		SpinLockRelease(&tenantStats->lock);
+	}
+
+	LWLockRelease(&monitor->lock);
+
+	if (cpuUsageInThisPeriod > StatTenantsCpuLimit)
+	{
+		ereport(ERROR, (errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+						errmsg("tenant \"%s\" of colocation group %d exceeded its "
+							   "CPU time limit", key->tenantAttribute,
+							   key->colocationGroupId),
+						errdetail("The tenant used %.3f seconds of CPU time in the "
+								  "current period, the limit is %.3f seconds.",
+								  cpuUsageInThisPeriod, StatTenantsCpuLimit),
+						errhint("Retry after the current citus.stat_tenants_period "
+								"ends or increase citus.stat_tenants_cpu_limit.")));
+	}
+}
+
+
 static void
 FillTenantStatsHashKey(TenantStatsHashKey *key, char *tenantAttribute, uint32
 					   colocationGroupId)
@@ -23,6 +23,7 @@
 #include "distributed/colocation_utils.h"
 #include "distributed/commands.h"
 #include "distributed/listutils.h"
+#include "distributed/log_utils.h"
 #include "distributed/metadata_utility.h"
 #include "distributed/coordinator_protocol.h"
 #include "distributed/metadata_cache.h"
@@ -42,6 +43,7 @@
 #include "distributed/version_compat.h"
 #include "distributed/local_executor.h"
 #include "distributed/worker_shard_visibility.h"
+#include "portability/instr_time.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
@@ -226,6 +228,9 @@ lock_shard_resources(PG_FUNCTION_ARGS)
 		aclMask |= ACL_INSERT;
 	}
 
+	/* shards of the same table typically come together, check permissions once */
+	List *permittedRelationList = NIL;
+
 	for (int shardIdIndex = 0; shardIdIndex < shardIdCount; shardIdIndex++)
 	{
 		int64 shardId = DatumGetInt64(shardIdArrayDatum[shardIdIndex]);
@@ -250,9 +255,12 @@ lock_shard_resources(PG_FUNCTION_ARGS)
 			continue;
 		}
 
-		if (!SkipAdvisoryLockPermissionChecks)
+		if (!SkipAdvisoryLockPermissionChecks &&
+			!list_member_oid(permittedRelationList, relationId))
 		{
 			EnsureTablePermissions(relationId, aclMask);
+
+			permittedRelationList = lappend_oid(permittedRelationList, relationId);
 		}
 
 		LockShardResource(shardId, lockMode);
@@ -331,11 +339,13 @@ LockShardListResourcesOnFirstWorker(LOCKMODE lockmode, List *shardIntervalList)
 	/* the SELECT .. FOR UPDATE breaks if we lose the connection */
 	MarkRemoteTransactionCritical(firstWorkerConnection);
 
-	/* make sure we are in a tranasaction block to hold the lock until commit */
-	RemoteTransactionBeginIfNecessary(firstWorkerConnection);
-
-	/* grab the lock on the first worker node */
-	ExecuteCriticalRemoteCommand(firstWorkerConnection, lockCommand->data);
+	/*
+	 * Grab the lock on the first worker node. If the remote transaction is not
+	 * started yet, the lock command goes along with the BEGIN to avoid paying
+	 * an additional round-trip on every modification of a replicated table.
+	 */
+	RemoteTransactionBeginAndExecuteCriticalCommand(firstWorkerConnection,
+													lockCommand->data);
 }
 
 
@@ -704,6 +714,14 @@ SerializeNonCommutativeWrites(List *shardIntervalList, LOCKMODE lockMode)
 		return;
 	}
 
+	/* measure how long we wait for the locks, only when anyone is listening */
+	bool measureLockTime = IsLoggableLevel(DEBUG4);
+	instr_time lockStart;
+	if (measureLockTime)
+	{
+		INSTR_TIME_SET_CURRENT(lockStart);
+	}
+
 	List *replicatedShardList = NIL;
 	if (AnyTableReplicated(shardIntervalList, &replicatedShardList))
 	{
@@ -728,6 +746,17 @@ SerializeNonCommutativeWrites(List *shardIntervalList, LOCKMODE lockMode)
 	}
 
 	LockShardListResources(shardIntervalList, lockMode);
+
+	if (measureLockTime)
+	{
+		instr_time lockDuration;
+		INSTR_TIME_SET_CURRENT(lockDuration);
+		INSTR_TIME_SUBTRACT(lockDuration, lockStart);
+
+		ereport(DEBUG4, (errmsg("acquired shard resource locks on %d shards in %.3f ms",
+								list_length(shardIntervalList),
+								INSTR_TIME_GET_MILLISEC(lockDuration))));
+	}
 }
 
 
@@ -745,18 +774,47 @@ AnyTableReplicated(List *shardIntervalList, List **replicatedShardIntervalList)
 {
 	List *localList = NIL;
 
+	/*
+	 * SingleReplicatedTable() goes over all the placements of the table, so
+	 * remember the outcome per table instead of repeating it for each shard.
+	 */
+	List *replicatedRelationList = NIL;
+	List *singleReplicatedRelationList = NIL;
+
 	ShardInterval *shardInterval = NULL;
 	foreach_ptr(shardInterval, shardIntervalList)
 	{
 		int64 shardId = shardInterval->shardId;
 
 		Oid relationId = RelationIdForShard(shardId);
-		if (ReferenceTableShardId(shardId))
+
+		bool relationReplicated = false;
+		if (list_member_oid(replicatedRelationList, relationId))
 		{
-			localList =
-				lappend(localList, LoadShardInterval(shardId));
+			relationReplicated = true;
 		}
-		else if (!SingleReplicatedTable(relationId))
+		else if (list_member_oid(singleReplicatedRelationList, relationId))
+		{
+			relationReplicated = false;
+		}
+		else
+		{
+			relationReplicated = ReferenceTableShardId(shardId) ||
+								 !SingleReplicatedTable(relationId);
+
+			if (relationReplicated)
+			{
+				replicatedRelationList = lappend_oid(replicatedRelationList,
+													 relationId);
+			}
+			else
+			{
+				singleReplicatedRelationList = lappend_oid(singleReplicatedRelationList,
+														   relationId);
+			}
+		}
+
+		if (relationReplicated)
 		{
 			localList =
 				lappend(localList, LoadShardInterval(shardId));
@@ -15,6 +15,7 @@
 #include "catalog/pg_am.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_type.h"
+#include "common/hashfn.h"
 #include "distributed/listutils.h"
 #include "distributed/metadata_cache.h"
 #include "distributed/multi_join_order.h"
@@ -24,7 +25,10 @@
 #include "distributed/pg_dist_partition.h"
 #include "distributed/worker_protocol.h"
 #include "utils/catcache.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/uuid.h"
 
 
 /*
@@ -451,6 +455,291 @@ CalculateUniformHashRangeIndex(int hashedValue, int shardCount)
 }
 
 
+/*
+ * CreateShardRoutingInfo builds a ShardRoutingInfo for the given cache entry,
+ * which can then be used to route distribution column values via
+ * RouteDistributionValue and RouteDistributionValueBatch.
+ *
+ * The cache entry is expected to stay valid for the lifetime of the routing
+ * info, which holds for the current transaction since invalidated cache entries
+ * are only freed at the end of the transaction.
+ */
+ShardRoutingInfo *
+CreateShardRoutingInfo(CitusTableCacheEntry *cacheEntry)
+{
+	ShardRoutingInfo *routingInfo = palloc0(sizeof(ShardRoutingInfo));
+	routingInfo->cacheEntry = cacheEntry;
+	routingInfo->hashKind = DISTRIBUTION_VALUE_HASH_FMGR;
+
+	if (!IsCitusTableTypeCacheEntry(cacheEntry, HASH_DISTRIBUTED))
+	{
+		return routingInfo;
+	}
+
+	Oid hashFunctionId = cacheEntry->hashFunction->fn_oid;
+	if (hashFunctionId == F_HASHINT4)
+	{
+		routingInfo->hashKind = DISTRIBUTION_VALUE_HASH_INT4;
+	}
+	else if (hashFunctionId == F_HASHINT8)
+	{
+		routingInfo->hashKind = DISTRIBUTION_VALUE_HASH_INT8;
+	}
+	else if (hashFunctionId == F_UUID_HASH)
+	{
+		routingInfo->hashKind = DISTRIBUTION_VALUE_HASH_UUID;
+	}
+	else if (hashFunctionId == F_HASHTEXT)
+	{
+		/*
+		 * hashtext only hashes the raw bytes for deterministic collations,
+		 * leave the rest (and the missing collation error) to the function.
+		 */
+		Oid collationId = cacheEntry->partitionColumn->varcollid;
+		if (OidIsValid(collationId) && get_collation_isdeterministic(collationId))
+		{
+			routingInfo->hashKind = DISTRIBUTION_VALUE_HASH_TEXT;
+		}
+	}
+
+	int shardCount = cacheEntry->shardIntervalArrayLength;
+	if (cacheEntry->hasUniformHashDistribution)
+	{
+		routingInfo->useUniformHashRanges = true;
+	}
+	else if (shardCount > 0 && !cacheEntry->hasUninitializedShardInterval)
+	{
+		routingInfo->shardMinHashValues = palloc0(shardCount * sizeof(int32));
+		routingInfo->shardMaxHashValues = palloc0(shardCount * sizeof(int32));
+
+		for (int shardIndex = 0; shardIndex < shardCount; shardIndex++)
+		{
+			ShardInterval *shardInterval =
+				cacheEntry->sortedShardIntervalArray[shardIndex];
+
+			routingInfo->shardMinHashValues[shardIndex] =
+				DatumGetInt32(shardInterval->minValue);
+			routingInfo->shardMaxHashValues[shardIndex] =
+				DatumGetInt32(shardInterval->maxValue);
+		}
+	}
+
+	return routingInfo;
+}
+
+
+/*
+ * HashDistributionValue computes the hash of a distribution column value in
+ * the same way as the hash function of the distribution column type would.
+ */
+static inline int32
+HashDistributionValue(ShardRoutingInfo *routingInfo, Datum value)
+{
+	switch (routingInfo->hashKind)
+	{
+		case DISTRIBUTION_VALUE_HASH_INT4:
+		{
+			/* same as hashint4 */
+			return DatumGetInt32(hash_uint32((uint32) DatumGetInt32(value)));
+		}
+
+		case DISTRIBUTION_VALUE_HASH_INT8:
+		{
+			/* same as hashint8, which is consistent with hashint4 for small values */
+			int64 int8Value = DatumGetInt64(value);
+			uint32 lowHalf = (uint32) int8Value;
+			uint32 highHalf = (uint32) (int8Value >> 32);
+
+			lowHalf ^= (int8Value >= 0) ? highHalf : ~highHalf;
+
+			return DatumGetInt32(hash_uint32(lowHalf));
+		}
+
+		case DISTRIBUTION_VALUE_HASH_TEXT:
+		{
+			/* same as hashtext for deterministic collations */
+			text *textValue = DatumGetTextPP(value);
+			Datum hashValue = hash_any((unsigned char *) VARDATA_ANY(textValue),
+									   VARSIZE_ANY_EXHDR(textValue));
+
+			if ((Pointer) textValue != DatumGetPointer(value))
+			{
+				pfree(textValue);
+			}
+
+			return DatumGetInt32(hashValue);
+		}
+
+		case DISTRIBUTION_VALUE_HASH_UUID:
+		{
+			/* same as uuid_hash */
+			pg_uuid_t *uuidValue = DatumGetUUIDP(value);
+
+			return DatumGetInt32(hash_any(uuidValue->data, UUID_LEN));
+		}
+
+		case DISTRIBUTION_VALUE_HASH_FMGR:
+		default:
+		{
+			CitusTableCacheEntry *cacheEntry = routingInfo->cacheEntry;
+
+			return DatumGetInt32(FunctionCall1Coll(cacheEntry->hashFunction,
+												   cacheEntry->partitionColumn->varcollid,
+												   value));
+		}
+	}
+}
+
+
+/*
+ * SearchShardHashRange performs a binary search over the hash ranges of a
+ * hash distributed table with non-uniform shard ranges and returns the index
+ * of the shard that contains the given hash value.
+ */
+static inline int
+SearchShardHashRange(ShardRoutingInfo *routingInfo, int32 hashedValue)
+{
+	int lowerBoundIndex = 0;
+	int upperBoundIndex = routingInfo->cacheEntry->shardIntervalArrayLength;
+
+	while (lowerBoundIndex < upperBoundIndex)
+	{
+		int middleIndex = (lowerBoundIndex + upperBoundIndex) / 2;
+
+		if (hashedValue < routingInfo->shardMinHashValues[middleIndex])
+		{
+			upperBoundIndex = middleIndex;
+			continue;
+		}
+
+		if (hashedValue <= routingInfo->shardMaxHashValues[middleIndex])
+		{
+			return middleIndex;
+		}
+
+		lowerBoundIndex = middleIndex + 1;
+	}
+
+	ereport(ERROR, (errcode(ERRCODE_DATA_EXCEPTION),
+					errmsg("cannot find shard interval"),
+					errdetail("Hash of the partition column value "
+							  "does not fall into any shards.")));
+}
+
+
+/*
+ * ShardIndexForHashedValue returns the index of the shard interval that
+ * contains the given hash value.
+ */
+static inline int
+ShardIndexForHashedValue(ShardRoutingInfo *routingInfo, int32 hashedValue)
+{
+	CitusTableCacheEntry *cacheEntry = routingInfo->cacheEntry;
+	int shardCount = cacheEntry->shardIntervalArrayLength;
+
+	if (shardCount == 0)
+	{
+		return INVALID_SHARD_INDEX;
+	}
+	else if (routingInfo->useUniformHashRanges)
+	{
+		return CalculateUniformHashRangeIndex(hashedValue, shardCount);
+	}
+	else if (routingInfo->shardMinHashValues != NULL)
+	{
+		return SearchShardHashRange(routingInfo, hashedValue);
+	}
+
+	return FindShardIntervalIndex(Int32GetDatum(hashedValue), cacheEntry);
+}
+
+
+/*
+ * RouteDistributionValue returns the index in the sorted shard interval array
+ * of the shard that contains the given (non-NULL) distribution column value,
+ * or INVALID_SHARD_INDEX if there is no such shard. It returns the same result
+ * as FindShardInterval, but without per-value fmgr calls for common hash
+ * distribution column types.
+ */
+int
+RouteDistributionValue(ShardRoutingInfo *routingInfo, Datum value)
+{
+	CitusTableCacheEntry *cacheEntry = routingInfo->cacheEntry;
+
+	if (!IsCitusTableTypeCacheEntry(cacheEntry, HASH_DISTRIBUTED))
+	{
+		return FindShardIntervalIndex(value, cacheEntry);
+	}
+
+	int32 hashedValue = HashDistributionValue(routingInfo, value);
+
+	return ShardIndexForHashedValue(routingInfo, hashedValue);
+}
+
+
+/*
+ * RouteDistributionValueBatch routes an array of (non-NULL) distribution
+ * column values at once and writes the resulting shard indexes into
+ * shardIndexes, which should have room for valueCount elements.
+ *
+ * We first hash all values and then resolve all hashes to shard indexes,
+ * which keeps the loops tight and lets the compiler specialize them per hash
+ * kind.
+ */
+void
+RouteDistributionValueBatch(ShardRoutingInfo *routingInfo, Datum *values,
+							int valueCount, int *shardIndexes)
+{
+	CitusTableCacheEntry *cacheEntry = routingInfo->cacheEntry;
+
+	if (!IsCitusTableTypeCacheEntry(cacheEntry, HASH_DISTRIBUTED))
+	{
+		for (int valueIndex = 0; valueIndex < valueCount; valueIndex++)
+		{
+			shardIndexes[valueIndex] = FindShardIntervalIndex(values[valueIndex],
+															  cacheEntry);
+		}
+
+		return;
+	}
+
+	int32 *hashedValues = palloc(valueCount * sizeof(int32));
+
+	switch (routingInfo->hashKind)
+	{
+		case DISTRIBUTION_VALUE_HASH_INT4:
+		{
+			for (int valueIndex = 0; valueIndex < valueCount; valueIndex++)
+			{
+				uint32 int4Value = (uint32) DatumGetInt32(values[valueIndex]);
+				hashedValues[valueIndex] = DatumGetInt32(hash_uint32(int4Value));
+			}
+
+			break;
+		}
+
+		default:
+		{
+			for (int valueIndex = 0; valueIndex < valueCount; valueIndex++)
+			{
+				hashedValues[valueIndex] = HashDistributionValue(routingInfo,
+																 values[valueIndex]);
+			}
+
+			break;
+		}
+	}
+
+	for (int valueIndex = 0; valueIndex < valueCount; valueIndex++)
+	{
+		shardIndexes[valueIndex] = ShardIndexForHashedValue(routingInfo,
+															hashedValues[valueIndex]);
+	}
+
+	pfree(hashedValues);
+}
+
+
 /*
  * SingleReplicatedTable checks whether all shards of a distributed table, do not have
  * more than one replica. If even one shard has more than one replica, this function
@@ -37,5 +37,7 @@ extern void LogicalClockShmemInit(void);
 extern size_t LogicalClockShmemSize(void);
 extern void InitializeClusterClockMem(void);
 extern ClusterClock * GetEpochTimeAsClock(void);
+extern char * TransactionClockAdjustmentCommand(void);
+extern void ResetTransactionClock(void);
 
 #endif /* CAUSAL_CLOCK_H */
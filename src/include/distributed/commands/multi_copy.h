@@ -15,6 +15,7 @@
 
 #include "distributed/metadata_utility.h"
 #include "distributed/metadata_cache.h"
+#include "distributed/shardinterval_utils.h"
 #include "distributed/version_compat.h"
 #include "nodes/execnodes.h"
 #include "nodes/parsenodes.h"
@@ -119,6 +120,9 @@ typedef struct CitusCopyDestReceiver
 	/* instructions for coercing incoming tuples */
 	CopyCoercionData *columnCoercionPaths;
 
+	/* routes partition column values of incoming tuples to shards */
+	ShardRoutingInfo *shardRoutingInfo;
+
 	/* number of tuples sent */
 	int64 tuplesSent;
 
@@ -157,6 +161,7 @@ typedef struct CitusCopyDestReceiver
 
 
 /* GUCs */
+extern bool SkipBinaryValidationInCopy;
 extern bool SkipJsonbValidationInCopy;
 
 /* managed via GUC, the default is 4MB */
@@ -27,6 +27,15 @@ typedef struct TransactionNode
 	/* list of TransactionNode that this distributed transaction is waiting for */
 	List *waitsFor;
 
+	/* list of TransactionNode that are waiting for this distributed transaction */
+	List *waitedBy;
+
+	/* number of waitsFor entries not yet known to be unable to deadlock */
+	int remainingWaitsForCount;
+
+	/* set if the transaction cannot be part of a cycle in the wait graph */
+	bool cannotDeadlock;
+
 	/* backend that is on the initiator node */
 	PGPROC *initiatorProc;
 
@@ -336,6 +336,8 @@ extern List * ShardPlacementListSortedByWorker(uint64 shardId);
 extern ShardPlacement * ActiveShardPlacement(uint64 shardId, bool missingOk);
 extern WorkerNode * ActiveShardPlacementWorkerNode(uint64 shardId);
 extern List * BuildShardPlacementList(int64 shardId);
+extern List * BuildShardPlacementListForShardIdRange(int64 minShardId,
+												   int64 maxShardId);
 extern List * AllShardPlacementsOnNodeGroup(int32 groupId);
 extern List * GroupShardPlacementsForTableOnGroup(Oid relationId, int32 groupId);
 extern void LookupTaskPlacementHostAndPort(ShardPlacement *taskPlacement, char **nodeName,
@@ -86,6 +86,7 @@ typedef struct JoinOrderNode
 /* Config variables managed via guc.c */
 extern bool LogMultiJoinOrder;
 extern bool EnableSingleHashRepartitioning;
+extern bool EnableNestedShardRangeJoins;
 
 
 /* Function declaration for determining table join orders */
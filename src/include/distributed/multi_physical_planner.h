@@ -574,6 +574,7 @@ extern bool ShardIntervalsOverlapWithParams(Datum firstMin, Datum firstMax,
 											FmgrInfo *comparisonFunction,
 											Oid collation);
 extern bool CoPartitionedTables(Oid firstRelationId, Oid secondRelationId);
+extern bool NestedShardRangeTables(Oid finerRelationId, Oid coarserRelationId);
 extern ShardInterval ** GenerateSyntheticShardIntervalArray(int partitionCount);
 extern RowModifyLevel RowModifyLevelForQuery(Query *query);
 extern StringInfo ArrayObjectToString(ArrayType *arrayObject,
@@ -64,6 +64,7 @@ extern PGresult * GetRemoteCommandResult(MultiConnection *connection,
 extern bool PutRemoteCopyData(MultiConnection *connection, const char *buffer,
 							  int nbytes);
 extern bool PutRemoteCopyEnd(MultiConnection *connection, const char *errormsg);
+extern bool StartRemoteCopyEnd(MultiConnection *connection, const char *errormsg);
 
 /* waiting for multiple command results */
 extern void WaitForAllConnections(List *connectionList, bool raiseInterrupts);
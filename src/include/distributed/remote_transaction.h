@@ -86,6 +86,9 @@ typedef struct RemoteTransaction
 
 	/* set when BEGIN is sent over the connection */
 	bool beginSent;
+
+	/* set when the transaction clock is sent along with PREPARE or COMMIT */
+	bool clockAdjustmentSent;
 } RemoteTransaction;
 
 
@@ -114,6 +117,8 @@ extern void RemoteTransactionAbort(struct MultiConnection *connection);
 /* start transaction if necessary */
 extern void RemoteTransactionBeginIfNecessary(struct MultiConnection *connection);
 extern void RemoteTransactionsBeginIfNecessary(List *connectionList);
+extern void RemoteTransactionBeginAndExecuteCriticalCommand(
+	struct MultiConnection *connection, const char *command);
 
 /* other public functionality */
 extern void HandleRemoteTransactionConnectionError(struct MultiConnection *connection,
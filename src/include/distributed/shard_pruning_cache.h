@@ -0,0 +1,25 @@
+/*-------------------------------------------------------------------------
+ *
+ * shard_pruning_cache.h
+ *   Per-backend cache of shard pruning results for router queries.
+ *
+ * Copyright (c) Citus Data, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef SHARD_PRUNING_CACHE_H
+#define SHARD_PRUNING_CACHE_H
+
+#include "distributed/metadata_cache.h"
+#include "nodes/primnodes.h"
+
+/* GUC, whether router planners may use the shard pruning cache */
+extern bool EnableShardPruningCache;
+
+extern ShardInterval * FindShardIntervalCached(CitusTableCacheEntry *cacheEntry,
+											   Const *distributionValue);
+extern List * CachedActiveShardPlacementList(Oid relationId, uint64 shardId);
+extern void InvalidateShardPruningCache(Oid relationId);
+
+#endif /* SHARD_PRUNING_CACHE_H */
@@ -35,6 +35,41 @@ typedef struct SortShardIntervalContext
 	Oid collation;
 } SortShardIntervalContext;
 
+/*
+ * DistributionValueHashKind describes how ShardRoutingInfo hashes distribution
+ * column values. For the most common distribution column types we can compute
+ * the same hash as the type's hash function without going through fmgr.
+ */
+typedef enum DistributionValueHashKind
+{
+	DISTRIBUTION_VALUE_HASH_FMGR = 0,
+	DISTRIBUTION_VALUE_HASH_INT4,
+	DISTRIBUTION_VALUE_HASH_INT8,
+	DISTRIBUTION_VALUE_HASH_TEXT,
+	DISTRIBUTION_VALUE_HASH_UUID
+} DistributionValueHashKind;
+
+/*
+ * ShardRoutingInfo contains the information that is needed to route many
+ * distribution column values to shard indexes of the same table. It is built
+ * once (e.g. at the start of a COPY) and then used for every row, such that
+ * we avoid fmgr calls and repeated cache lookups per row.
+ */
+typedef struct ShardRoutingInfo
+{
+	CitusTableCacheEntry *cacheEntry;
+
+	/* how to hash values, only relevant for hash distributed tables */
+	DistributionValueHashKind hashKind;
+
+	/* whether the shard index can be computed directly from the hash value */
+	bool useUniformHashRanges;
+
+	/* shard interval boundaries for non-uniform hash distributed tables */
+	int32 *shardMinHashValues;
+	int32 *shardMaxHashValues;
+} ShardRoutingInfo;
+
 extern ShardInterval ** SortShardIntervalArray(ShardInterval **shardIntervalArray, int
 											   shardCount, Oid collation,
 											   FmgrInfo *shardIntervalSortCompareFunction);
@@ -54,6 +89,10 @@ extern int SearchCachedShardInterval(Datum partitionColumnValue,
 									 ShardInterval **shardIntervalCache,
 									 int shardCount, Oid shardIntervalCollation,
 									 FmgrInfo *compareFunction);
+extern ShardRoutingInfo * CreateShardRoutingInfo(CitusTableCacheEntry *cacheEntry);
+extern int RouteDistributionValue(ShardRoutingInfo *routingInfo, Datum value);
+extern void RouteDistributionValueBatch(ShardRoutingInfo *routingInfo, Datum *values,
+										int valueCount, int *shardIndexes);
 extern bool SingleReplicatedTable(Oid relationId);
 
 
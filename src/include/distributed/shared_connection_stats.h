@@ -32,6 +32,9 @@ extern int GetMaxSharedPoolSize(void);
 extern int GetLocalSharedPoolSize(void);
 extern bool TryToIncrementSharedConnectionCounter(const char *hostname, int port);
 extern void WaitLoopForSharedConnection(const char *hostname, int port);
+extern bool SharedConnectionHasWaiters(const char *hostname, int port);
+extern int SharedConnectionWaiterCount(const char *hostname, int port);
+extern void UnregisterSharedConnectionWaiter(void);
 extern void DecrementSharedConnectionCounter(const char *hostname, int port);
 extern void IncrementSharedConnectionCounter(const char *hostname, int port);
 extern int AdaptiveConnectionManagementFlag(bool connectToLocalNode, int
@@ -133,6 +133,9 @@ extern bool AllModificationsCommutative;
 /* we've deprecated this flag, keeping here for some time not to break existing users */
 extern bool EnableDeadlockPrevention;
 
+/* controls skipping 2PC when a single remote transaction did writes */
+extern bool Skip2PCForSingleNodeTransactions;
+
 /* number of nested stored procedure call levels we are currently in */
 extern int StoredProcedureLevel;
 
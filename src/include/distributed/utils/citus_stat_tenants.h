@@ -117,6 +117,7 @@ extern void AttributeTask(char *tenantId, int colocationGroupId, CmdType command
 
 extern ExecutorEnd_hook_type prev_ExecutorEnd;
 
+extern double StatTenantsCpuLimit;
 extern int StatTenantsLogLevel;
 extern int StatTenantsPeriod;
 extern int StatTenantsLimit;
@@ -1,5 +1,8 @@
 setup
 {
+   -- do not let the connections of this session hold connection slots
+   SET citus.max_cached_conns_per_worker TO 0;
+
    CREATE OR REPLACE FUNCTION wake_up_connection_pool_waiters()
    RETURNS void
    LANGUAGE C STABLE STRICT
@@ -10,6 +13,11 @@ setup
    LANGUAGE C STABLE STRICT
    AS 'citus', $$set_max_shared_pool_size$$;
 
+   CREATE OR REPLACE FUNCTION shared_connection_waiter_count(text, int)
+   RETURNS int
+   LANGUAGE C STABLE STRICT
+   AS 'citus', $$shared_connection_waiter_count$$;
+
    CREATE TABLE test (a int, b  int);
    SET citus.shard_count TO 32;
    SELECT create_distributed_table('test', 'a');
@@ -22,6 +30,7 @@ teardown
 	 SELECT set_max_shared_pool_size(100);
 	DROP FUNCTION wake_up_connection_pool_waiters();
 	DROP FUNCTION set_max_shared_pool_size(int);
+	DROP FUNCTION shared_connection_waiter_count(text, int);
 	DROP TABLE test;
 }
 
@@ -45,11 +54,33 @@ step "s1-commit"
 
 session "s2"
 
+setup
+{
+	SET citus.max_cached_conns_per_worker TO 0;
+}
+
 step "s2-select"
 {
        SELECT count(*) FROM test;
 }
 
+step "s2-select-single-shard"
+{
+	SELECT count(*) FROM test WHERE a = 1;
+}
+
+step "s2-set-statement-timeout"
+{
+	SET statement_timeout TO 500;
+}
+
+step "s2-reset-statement-timeout"
+{
+	RESET statement_timeout;
+}
+
+step "s2-wait" {}
+
 session "s3"
 
 step "s3-lower-pool-size"
@@ -57,10 +88,44 @@ step "s3-lower-pool-size"
 	SELECT set_max_shared_pool_size(5);
 }
 
+step "s3-lower-pool-size-to-one"
+{
+	SELECT set_max_shared_pool_size(1);
+	SELECT pg_sleep(0.5);
+}
+
 step "s3-increase-pool-size"
 {
 	SELECT set_max_shared_pool_size(100);
 }
 
+step "s3-wait-for-waiter"
+{
+	DO $$
+	BEGIN
+		FOR i IN 1 .. 100 LOOP
+			EXIT WHEN (SELECT sum(shared_connection_waiter_count(node_name, node_port))
+					   FROM master_get_active_worker_nodes()) > 0;
+			PERFORM pg_sleep(0.1);
+		END LOOP;
+	END;
+	$$;
+	SELECT sum(shared_connection_waiter_count(node_name, node_port)) AS waiting_backends
+	FROM master_get_active_worker_nodes();
+}
+
+step "s3-show-waiters"
+{
+	SELECT sum(shared_connection_waiter_count(node_name, node_port)) AS waiting_backends
+	FROM master_get_active_worker_nodes();
+}
+
 permutation "s3-lower-pool-size" "s1-begin" "s1-count-slow" "s3-increase-pool-size" "s2-select" "s1-commit"
 
+// s1 keeps its connections cached at the end of its transaction, unless another
+// backend waits for a connection slot on the same node. s2 needs the slot that
+// s1 holds, so it can only finish once s1 closes its connection on commit.
+permutation "s3-lower-pool-size-to-one" "s1-begin" "s1-count-slow" "s2-select-single-shard"(*) "s3-wait-for-waiter" "s1-commit" "s2-wait" "s3-show-waiters" "s3-increase-pool-size"
+
+// a backend that stops waiting because of an error no longer counts as a waiter
+permutation "s3-lower-pool-size-to-one" "s1-begin" "s1-count-slow" "s2-set-statement-timeout" "s2-select-single-shard" "s2-reset-statement-timeout" "s3-show-waiters" "s1-commit" "s3-increase-pool-size"
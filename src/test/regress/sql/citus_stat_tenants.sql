@@ -418,6 +418,29 @@ SELECT tenant_attribute, read_count_in_this_period, read_count_in_last_period, q
 FROM citus_stat_tenants(true)
 ORDER BY tenant_attribute;
 
+-- test the CPU time limit, queries of a tenant that used more CPU time than
+-- the limit in the current period are rejected
+SELECT citus_stat_tenants_reset();
+SELECT result FROM run_command_on_all_nodes('ALTER SYSTEM SET citus.stat_tenants_cpu_limit TO 0.000000001');
+SELECT result FROM run_command_on_all_nodes('SELECT pg_reload_conf()');
+SELECT pg_sleep(0.1);
+-- the first query of a tenant starts tracking it
+SELECT count(*)>=0 FROM dist_tbl WHERE a = 1;
+DO $$
+BEGIN
+    PERFORM count(*) FROM dist_tbl WHERE a = 1;
+EXCEPTION WHEN configuration_limit_exceeded THEN
+    RAISE NOTICE 'query of the tenant was rejected';
+END;
+$$;
+-- other tenants are not affected
+SELECT count(*)>=0 FROM dist_tbl WHERE a = 2;
+-- without the limit, the tenant is admitted again
+SELECT result FROM run_command_on_all_nodes('ALTER SYSTEM RESET citus.stat_tenants_cpu_limit');
+SELECT result FROM run_command_on_all_nodes('SELECT pg_reload_conf()');
+SELECT pg_sleep(0.1);
+SELECT count(*)>=0 FROM dist_tbl WHERE a = 1;
+
 SET client_min_messages TO ERROR;
 DROP SCHEMA citus_stat_tenants CASCADE;
 DROP SCHEMA citus_stat_tenants_t1 CASCADE;
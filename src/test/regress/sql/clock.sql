@@ -106,6 +106,12 @@ BEGIN;
 SELECT citus_get_transaction_clock();
 END;
 
+-- Move the clock of the coordinator ahead of the workers, such that the
+-- transaction clock is picked from the coordinator and the workers only
+-- reach it by adjusting to it
+SELECT citus_internal_adjust_local_clock_to_remote(
+	format('(%s, 0)', cluster_clock_logical(citus_get_node_clock()) + 60000)::cluster_clock);
+
 -- Transaction that accesses multiple nodes
 BEGIN;
 INSERT INTO clock_test SELECT generate_series(1, 10000, 1), 0;
@@ -121,6 +127,13 @@ COMMIT;
 SELECT result as logseq from run_command_on_workers($$SELECT last_value FROM pg_dist_clock_logical_seq$$) limit 1 \gset
 SELECT cluster_clock_logical(:'txnclock') as txnlog \gset
 SELECT :logseq = :txnlog;
+-- All the workers adjusted to the transaction clock along with PREPARE TRANSACTION
+SELECT bool_and(result::bigint = :txnlog) FROM run_command_on_workers($$SELECT last_value FROM pg_dist_clock_logical_seq$$);
+
+-- Move the clock of the coordinator ahead again, the workers only reach the
+-- next transaction clock if they adjust to it
+SELECT citus_internal_adjust_local_clock_to_remote(
+	format('(%s, 0)', cluster_clock_logical(citus_get_node_clock()) + 60000)::cluster_clock);
 
 BEGIN;
 INSERT INTO clock_test SELECT generate_series(1, 10000, 1), 0;
@@ -133,7 +146,19 @@ ROLLBACK;
 
 SELECT result as logseq from run_command_on_workers($$SELECT last_value FROM pg_dist_clock_logical_seq$$) limit 1 \gset
 SELECT cluster_clock_logical(:'txnclock') as txnlog \gset
-SELECT :logseq = :txnlog;
+-- The workers do not adjust to the transaction clock on ROLLBACK
+SELECT :logseq < :txnlog;
+
+-- Transactions without modifications are committed without 2PC, the workers
+-- adjust to the transaction clock along with the COMMIT
+SET client_min_messages TO NOTICE;
+BEGIN;
+SELECT count(*) > 0 FROM clock_test;
+SELECT citus_get_transaction_clock() as txnclock \gset
+COMMIT;
+SELECT cluster_clock_logical(:'txnclock') as txnlog \gset
+SELECT bool_and(result::bigint = :txnlog) FROM run_command_on_workers($$SELECT last_value FROM pg_dist_clock_logical_seq$$);
+SET client_min_messages TO DEBUG1;
 
 SELECT run_command_on_workers($$SELECT citus_get_node_clock()$$);
 
@@ -156,6 +181,38 @@ BEGIN;
 SELECT citus_get_transaction_clock();
 COMMIT;
 
+-- Adjusting the clocks of the remote nodes needs a privilege, which is checked
+-- when the transaction clock is picked
+SET client_min_messages TO NOTICE;
+RESET ROLE;
+GRANT USAGE ON SCHEMA clock TO non_super_user_clock;
+GRANT SELECT, INSERT ON clock_test TO non_super_user_clock;
+SET ROLE non_super_user_clock;
+BEGIN;
+SELECT count(*) > 0 FROM clock_test;
+SELECT citus_get_transaction_clock();
+ROLLBACK;
+-- When a worker fails to adjust its clock, PREPARE TRANSACTION does not run
+-- there and the transaction is aborted on all the nodes
+RESET ROLE;
+SET citus.enable_ddl_propagation TO OFF;
+GRANT EXECUTE ON FUNCTION citus_internal_adjust_local_clock_to_remote(cluster_clock) TO non_super_user_clock;
+RESET citus.enable_ddl_propagation;
+SET ROLE non_super_user_clock;
+BEGIN;
+INSERT INTO clock_test SELECT generate_series(1, 100, 1), -1;
+SELECT citus_get_transaction_clock() IS NOT NULL;
+COMMIT;
+SELECT count(*) FROM clock_test WHERE nonid = -1;
+RESET ROLE;
+SET citus.enable_ddl_propagation TO OFF;
+REVOKE EXECUTE ON FUNCTION citus_internal_adjust_local_clock_to_remote(cluster_clock) FROM non_super_user_clock;
+RESET citus.enable_ddl_propagation;
+REVOKE ALL ON SCHEMA clock FROM non_super_user_clock;
+REVOKE ALL ON clock_test FROM non_super_user_clock;
+SET ROLE non_super_user_clock;
+SET client_min_messages TO DEBUG1;
+
 -- Test setting the persisted clock value (it must fail)
 SELECT setval('pg_dist_clock_logical_seq', 100, true);
 
@@ -75,6 +75,10 @@ ORDER BY 1;
 -- ORDER BY 1, 2;
 
 
+-- connections are cached across transactions, there is no separate setting
+-- to establish them ahead of the first distributed query
+SHOW citus.prestart_worker_connections;
+
 -- in case other tests relies on these setting, reset them
 ALTER SYSTEM RESET citus.distributed_deadlock_detection_factor;
 ALTER SYSTEM RESET citus.recover_2pc_interval;
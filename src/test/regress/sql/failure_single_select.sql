@@ -79,6 +79,7 @@ COMMIT;
 
 SELECT citus.mitmproxy('conn.onQuery(query="SELECT.*pg_prepared_xacts").after(2).kill()');
 SELECT recover_prepared_transactions();
+-- a failure on one worker does not stop recovery on the other workers
 SELECT recover_prepared_transactions();
 
 -- bug from https://github.com/citusdata/citus/issues/1926
@@ -792,3 +792,42 @@ red	{"r":255,"g":0,"b":0
 \.
 
 DROP TABLE copy_jsonb;
+
+-- binary COPY forwards variable length columns to the workers without decoding
+-- them on the coordinator when citus.skip_binary_validation_in_copy is set
+CREATE TABLE copy_binary(key text, name text, tags text[], payload jsonb, amount numeric, counter int);
+SELECT create_distributed_table('copy_binary', 'key');
+INSERT INTO copy_binary VALUES
+  ('k1', 'one', '{a,b}', '{"x": 1}', 1.5, 10),
+  ('k2', 'two', NULL, NULL, 2.25, 20),
+  ('k3', NULL, '{}', '[]', NULL, NULL);
+COPY copy_binary TO :'temp_dir''copy_binary.pgcopy' WITH (format binary);
+COPY copy_binary (key, payload) TO :'temp_dir''copy_binary_partial.pgcopy' WITH (format binary);
+
+-- a text column in the input of a jsonb column is not valid jsonb
+CREATE TABLE copy_binary_invalid(key text, payload text);
+INSERT INTO copy_binary_invalid VALUES ('k4', 'abc');
+COPY copy_binary_invalid TO :'temp_dir''copy_binary_invalid.pgcopy' WITH (format binary);
+
+SET citus.skip_binary_validation_in_copy TO on;
+TRUNCATE copy_binary;
+COPY copy_binary FROM :'temp_dir''copy_binary.pgcopy' WITH (format binary);
+SELECT * FROM copy_binary ORDER BY key;
+
+-- with a column list
+TRUNCATE copy_binary;
+COPY copy_binary (key, payload) FROM :'temp_dir''copy_binary_partial.pgcopy' WITH (format binary);
+SELECT * FROM copy_binary ORDER BY key;
+
+-- invalid values are rejected by the workers: no line number
+COPY copy_binary (key, payload) FROM :'temp_dir''copy_binary_invalid.pgcopy' WITH (format binary);
+
+SET citus.skip_binary_validation_in_copy TO off;
+TRUNCATE copy_binary;
+COPY copy_binary FROM :'temp_dir''copy_binary.pgcopy' WITH (format binary);
+SELECT * FROM copy_binary ORDER BY key;
+
+-- invalid values are rejected by the coordinator: should see line number
+COPY copy_binary (key, payload) FROM :'temp_dir''copy_binary_invalid.pgcopy' WITH (format binary);
+
+DROP TABLE copy_binary, copy_binary_invalid;
@@ -259,6 +259,23 @@ SELECT indisvalid AS "Index Valid?" FROM pg_index WHERE indexrelid='ith_b_idx'::
 \c - - - :worker_1_port
 SET search_path TO multi_index_statements;
 
+-- create an index on the shell table that will conflict with the metadata sync
+SET citus.enable_ddl_propagation TO off;
+CREATE INDEX CONCURRENTLY ith_c_idx ON index_test_hash(c);
+\c - - - :master_port
+SET search_path TO multi_index_statements;
+SELECT hasmetadata FROM pg_dist_node WHERE nodeport = :worker_1_port;
+-- should fail because the index already exists on the shell table of the worker
+CREATE INDEX CONCURRENTLY ith_c_idx ON index_test_hash(c);
+SELECT indisvalid AS "Index Valid?" FROM pg_index WHERE indexrelid='ith_c_idx'::regclass;
+-- dropping the index also drops the conflicting one on the worker
+DROP INDEX CONCURRENTLY IF EXISTS ith_c_idx;
+CREATE INDEX CONCURRENTLY ith_c_idx ON index_test_hash(c);
+SELECT indisvalid AS "Index Valid?" FROM pg_index WHERE indexrelid='ith_c_idx'::regclass;
+DROP INDEX CONCURRENTLY ith_c_idx;
+\c - - - :worker_1_port
+SET search_path TO multi_index_statements;
+
 -- now drop shard index to test partial master DROP failure
 DROP INDEX CONCURRENTLY ith_b_idx_102089;
 
@@ -63,6 +63,26 @@ CREATE TABLE customer_hash (
 	c_comment varchar(117) not null);
 SELECT create_distributed_table('customer_hash', 'c_custkey');
 
+-- Tables whose shard ranges nest, but which are not colocated. The replicated
+-- tables have placements of all shards on all nodes.
+SET citus.shard_count TO 4;
+CREATE TABLE nested_fine (key int, value int);
+SELECT create_distributed_table('nested_fine', 'key', colocate_with => 'none');
+SET citus.shard_count TO 2;
+CREATE TABLE nested_coarse (key int, value int);
+SELECT create_distributed_table('nested_coarse', 'key', colocate_with => 'none');
+
+SET citus.shard_replication_factor TO 2;
+SET citus.shard_count TO 4;
+CREATE TABLE nested_fine_replicated (key int, value int);
+SELECT create_distributed_table('nested_fine_replicated', 'key', colocate_with => 'none');
+SET citus.shard_count TO 2;
+CREATE TABLE nested_coarse_replicated (key int, value int);
+SELECT create_distributed_table('nested_coarse_replicated', 'key', colocate_with => 'none');
+INSERT INTO nested_fine_replicated SELECT i, i FROM generate_series(1, 100) i;
+INSERT INTO nested_coarse_replicated SELECT i, i FROM generate_series(1, 100) i;
+SET citus.shard_replication_factor TO 1;
+
 SET client_min_messages TO DEBUG2;
 -- The following query checks that we can correctly handle self-joins
 
@@ -135,9 +155,43 @@ JOIN (
      WHERE event_type = 5
 ) AS some_users ON (some_users.user_id = bar.user_id);
 
+-- Joins between tables whose shard ranges nest are done locally when the
+-- covering shards are on the same nodes.
+SET citus.enable_nested_shard_range_joins TO on;
+
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM nested_fine_replicated f, nested_coarse_replicated c
+	WHERE f.key = c.key;
+
+SELECT count(*) FROM nested_fine_replicated f, nested_coarse_replicated c
+	WHERE f.key = c.key;
+
+-- With the default round-robin placement, the covering shards are on other
+-- nodes, so we repartition.
+
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM nested_fine f, nested_coarse c
+	WHERE f.key = c.key;
+
+-- We also repartition when the feature is disabled.
+SET citus.enable_nested_shard_range_joins TO off;
+
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM nested_fine_replicated f, nested_coarse_replicated c
+	WHERE f.key = c.key;
+
+SELECT count(*) FROM nested_fine_replicated f, nested_coarse_replicated c
+	WHERE f.key = c.key;
+
+RESET citus.enable_nested_shard_range_joins;
+
 -- Reset client logging level to its previous value
 SET client_min_messages TO NOTICE;
 
 DROP TABLE lineitem_hash;
 DROP TABLE orders_hash;
 DROP TABLE customer_hash;
+DROP TABLE nested_fine;
+DROP TABLE nested_coarse;
+DROP TABLE nested_fine_replicated;
+DROP TABLE nested_coarse_replicated;
@@ -7,6 +7,11 @@ CREATE TABLE lineitem_hash (LIKE lineitem);
 SELECT create_distributed_table('lineitem_hash', 'l_orderkey', 'hash');
 INSERT INTO lineitem_hash SELECT * FROM lineitem;
 
+CREATE TABLE limit_top_n (tenant int, category int, score int);
+SELECT create_distributed_table('limit_top_n', 'tenant', 'hash');
+INSERT INTO limit_top_n SELECT i % 10, i % 7, (i * 37) % 50 FROM generate_series(1, 100) i;
+INSERT INTO limit_top_n VALUES (1, 7, NULL), (2, 7, NULL), (3, 7, 49);
+
 -- Display debug messages on limit clause push down.
 
 SET client_min_messages TO DEBUG1;
@@ -159,9 +164,9 @@ SELECT
 	ORDER BY l_orderkey + 1
 	LIMIT 5;
 
--- Limit is not pushed down when there are aggregates in the query
--- This is because group by is not on distribution column itself
--- but on an expression on distribution column
+-- Limit is pushed down when there are aggregates in the query even though
+-- group by is not on distribution column itself, because the group by
+-- expression comes first in the order by
 SELECT
 	DISTINCT ON (l_orderkey + 1, count(*)) l_orderkey + 1, count(*)
 	FROM lineitem_hash
@@ -222,6 +227,42 @@ SELECT
 	ORDER BY 2 DESC, 1
 	LIMIT 5;
 
+-- Push down the limit when the leading order by clauses cover all group by
+-- clauses, even if they are followed by an aggregate.
+SELECT category, sum(score) FROM limit_top_n
+	GROUP BY category
+	ORDER BY category, 2 DESC LIMIT 3;
+
+-- Push down the limit when ordering by max() DESC NULLS LAST, ties are broken
+-- by the group by column.
+SELECT category, max(score) FROM limit_top_n
+	GROUP BY category
+	ORDER BY max(score) DESC NULLS LAST, category LIMIT 4;
+
+-- Same for min() ASC NULLS LAST.
+SELECT category, min(score) FROM limit_top_n
+	GROUP BY category
+	ORDER BY min(score) ASC NULLS LAST, category LIMIT 3;
+
+-- Don't push down if NULLs of max() come first, since a group that is NULL on
+-- one shard may have values on other shards.
+SELECT category, max(score) FROM limit_top_n
+	GROUP BY category
+	ORDER BY max(score) DESC, category LIMIT 4;
+
+-- Don't push down if there are other aggregates in the target list, since
+-- they may miss values from the shards we don't fetch the group from.
+SELECT category, max(score), count(*) FROM limit_top_n
+	GROUP BY category
+	ORDER BY 2 DESC NULLS LAST, 1 LIMIT 3;
+
+-- Don't push down if there is a having clause, since groups that are in the
+-- first rows of a shard may be filtered out after merging.
+SELECT category, sum(score) FROM limit_top_n
+	GROUP BY category
+	HAVING count(*) > 14
+	ORDER BY category, 2 DESC LIMIT 3;
+
 SET client_min_messages TO NOTICE;
 
 -- non constants should not push down
@@ -241,3 +282,4 @@ SELECT l_orderkey FROM lineitem_hash ORDER BY l_orderkey LIMIT (SELECT 10);
 SELECT l_orderkey FROM lineitem_hash ORDER BY l_orderkey LIMIT 10 OFFSET (SELECT 10);
 
 DROP TABLE lineitem_hash;
+DROP TABLE limit_top_n;
@@ -3,6 +3,10 @@
 --
 
 
+CREATE TABLE limit_approximate (tenant int, category int, value int);
+SELECT create_distributed_table('limit_approximate', 'tenant');
+INSERT INTO limit_approximate SELECT i % 20, i % 20, i FROM generate_series(1, 200) i;
+
 -- Display debug messages on limit clause push down.
 
 SET client_min_messages TO DEBUG1;
@@ -73,5 +77,16 @@ SELECT count(*) count_quantity, l_quantity FROM lineitem WHERE l_quantity < 10.0
 	GROUP BY l_quantity
 	ORDER BY count_quantity ASC, l_quantity ASC;
 
+-- Workers return at least as many rows as the limit, even when the fetch
+-- count is lower. All rows of a category are on the same shard here, so the
+-- approximation gives the exact result.
+SET citus.limit_clause_row_fetch_count TO 2;
+
+SELECT category, sum(value) FROM limit_approximate
+	GROUP BY category
+	ORDER BY 2 DESC LIMIT 5;
+
 RESET citus.limit_clause_row_fetch_count;
 RESET client_min_messages;
+
+DROP TABLE limit_approximate;
@@ -133,3 +133,12 @@ SELECT create_distributed_table('table_with_temp_sequence', 'dist_key');
 DROP TABLE test_table CASCADE;
 DROP SEQUENCE test_sequence_0;
 DROP SEQUENCE test_sequence_1;
+
+-- a failure of the metadata command on the workers fails the DDL command
+CREATE TABLE ddl_conflict (a int);
+SELECT create_distributed_table('ddl_conflict', 'a');
+SELECT run_command_on_workers($$CREATE TABLE public.ddl_conflict_renamed (a int)$$);
+ALTER TABLE ddl_conflict RENAME TO ddl_conflict_renamed;
+SELECT run_command_on_workers($$DROP TABLE public.ddl_conflict_renamed$$);
+ALTER TABLE ddl_conflict RENAME TO ddl_conflict_renamed;
+DROP TABLE ddl_conflict_renamed;
@@ -124,6 +124,13 @@ hello-1
 SELECT count(*) FROM pg_dist_transaction;
 SELECT recover_prepared_transactions();
 
+-- Recovery records are written once PREPARE TRANSACTION is sent, one for each
+-- prepared transaction, and they remain after the commit until recovery runs
+INSERT INTO test_recovery (x) SELECT 'hello-'||s FROM generate_series(101,200) s;
+SELECT count(*), count(DISTINCT groupid), bool_and(gid LIKE 'citus\_%') FROM pg_dist_transaction;
+SELECT recover_prepared_transactions();
+SELECT count(*) FROM pg_dist_transaction;
+
 -- Create a single-replica table to enable 2PC in multi-statement transactions
 SET citus.shard_replication_factor TO 1;
 CREATE TABLE test_recovery_single (LIKE test_recovery);
@@ -242,6 +249,41 @@ COMMIT;
 SELECT count(*) FROM pg_dist_transaction;
 SELECT recover_prepared_transactions();
 
+-- citus.skip_2pc_for_single_node_transactions commits without 2PC when a
+-- single remote transaction did all the modifications
+SET citus.shard_count TO 2;
+CREATE TABLE test_1pc (a int, b int);
+SELECT create_distributed_table('test_1pc', 'a');
+INSERT INTO test_1pc SELECT i, i FROM generate_series(1, 10) i;
+-- move all shards to the first worker
+SELECT citus_move_shard_placement(shardid, 'localhost', :worker_2_port, 'localhost', :worker_1_port, shard_transfer_mode := 'block_writes')
+FROM pg_dist_shard_placement JOIN pg_dist_shard USING (shardid)
+WHERE logicalrelid = 'test_1pc'::regclass AND nodeport = :worker_2_port;
+SELECT recover_prepared_transactions();
+SET citus.force_max_query_parallelization TO OFF;
+SET citus.multi_shard_modify_mode TO 'sequential';
+SET citus.skip_2pc_for_single_node_transactions TO ON;
+-- the multi-shard update uses a single connection to the first worker
+UPDATE test_1pc SET b = b + 1;
+SELECT count(*) FROM pg_dist_transaction;
+-- modifications over connections to both workers still use 2PC
+BEGIN;
+UPDATE test_1pc SET b = b + 1;
+INSERT INTO test_2pcskip VALUES (6);
+INSERT INTO test_2pcskip VALUES (7);
+COMMIT;
+SELECT count(*) FROM pg_dist_transaction;
+SELECT recover_prepared_transactions();
+-- without the setting, the single-worker update uses 2PC
+SET citus.skip_2pc_for_single_node_transactions TO OFF;
+UPDATE test_1pc SET b = b + 1;
+SELECT count(*) FROM pg_dist_transaction;
+SELECT recover_prepared_transactions();
+SELECT sum(b) FROM test_1pc;
+RESET citus.skip_2pc_for_single_node_transactions;
+RESET citus.multi_shard_modify_mode;
+RESET citus.force_max_query_parallelization;
+
 -- Test whether auto-recovery runs
 ALTER SYSTEM SET citus.recover_2pc_interval TO 10;
 SELECT pg_reload_conf();
@@ -256,4 +298,5 @@ DROP TABLE test_recovery_ref;
 DROP TABLE test_recovery;
 DROP TABLE test_recovery_single;
 DROP TABLE test_2pcskip;
+DROP TABLE test_1pc;
 DROP TABLE test_reference;
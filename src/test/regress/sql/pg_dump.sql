@@ -25,6 +25,24 @@ COPY data FROM STDIN WITH (format csv, delimiter '|', escape '\');
 -- data should now appear twice
 COPY data TO STDOUT;
 
+-- the COPY of the next shard is started while the current one is forwarded,
+-- which should not change the order of the rows or repeat the header
+COPY data TO STDOUT WITH (format csv, header);
+-- shards are not prefetched in a transaction block, where the COPY has to use
+-- the connections that modified the placements
+BEGIN;
+INSERT INTO data VALUES (4, 'in transaction');
+COPY data TO STDOUT;
+ROLLBACK;
+-- shards are not prefetched when there is no connection slot left
+ALTER SYSTEM SET citus.max_shared_pool_size TO 1;
+SELECT pg_reload_conf();
+SELECT pg_sleep(0.1);
+COPY data TO STDOUT;
+ALTER SYSTEM RESET citus.max_shared_pool_size;
+SELECT pg_reload_conf();
+SELECT pg_sleep(0.1);
+
 CREATE TABLE simple_columnar(i INT, t TEXT) USING columnar;
 
 INSERT INTO simple_columnar VALUES (1, 'one'), (2, 'two');
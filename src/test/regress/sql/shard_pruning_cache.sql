@@ -0,0 +1,91 @@
+--
+-- SHARD_PRUNING_CACHE
+--
+-- Tests that router queries that use the shard pruning cache see shard
+-- moves, splits and drops of the table.
+--
+SET citus.next_shard_id TO 20800000;
+SET citus.shard_count TO 4;
+SET citus.shard_replication_factor TO 1;
+CREATE SCHEMA shard_pruning_cache;
+SET search_path TO shard_pruning_cache;
+
+CREATE TABLE pruning_cache_test (id int PRIMARY KEY, value text);
+SELECT create_distributed_table('pruning_cache_test', 'id');
+INSERT INTO pruning_cache_test SELECT i, 'value ' || i FROM generate_series(1, 20) i;
+
+-- checks that every row can be found by a router query on its id
+CREATE FUNCTION check_router_queries()
+RETURNS void LANGUAGE plpgsql AS $$
+DECLARE
+    found_id int;
+BEGIN
+    FOR i IN 1..20 LOOP
+        EXECUTE format('SELECT id FROM pruning_cache_test WHERE id = %s', i) INTO found_id;
+        IF found_id IS DISTINCT FROM i THEN
+            RAISE 'router query did not find id %', i;
+        END IF;
+    END LOOP;
+END;
+$$;
+
+PREPARE select_by_id(int) AS SELECT * FROM pruning_cache_test WHERE id = $1;
+
+-- fill the cache, also with a generic plan for the prepared statement
+SELECT check_router_queries();
+EXECUTE select_by_id(1);
+EXECUTE select_by_id(1);
+EXECUTE select_by_id(1);
+EXECUTE select_by_id(1);
+EXECUTE select_by_id(1);
+EXECUTE select_by_id(1);
+
+-- move the shard of id 1 to the other worker and drop the old placement
+SELECT citus_move_shard_placement(shardid, nodename, nodeport, 'localhost',
+                                  CASE WHEN nodeport = :worker_1_port THEN :worker_2_port ELSE :worker_1_port END,
+                                  shard_transfer_mode := 'block_writes')
+FROM pg_dist_shard_placement
+WHERE shardid = get_shard_id_for_distribution_column('pruning_cache_test', 1);
+SELECT public.wait_for_resource_cleanup();
+
+-- queries go to the new placement
+SELECT * FROM pruning_cache_test WHERE id = 1;
+EXECUTE select_by_id(1);
+UPDATE pruning_cache_test SET value = 'moved' WHERE id = 1;
+SELECT result FROM run_command_on_placements('pruning_cache_test', 'SELECT value FROM %s WHERE id = 1')
+WHERE shardid = get_shard_id_for_distribution_column('pruning_cache_test', 1);
+
+-- split the shard of id 1, which changes the shard indexes of the table
+SELECT citus_split_shard_by_split_points(
+    s.shardid,
+    ARRAY[(s.shardminvalue::int + (s.shardmaxvalue::int - s.shardminvalue::int) / 2)::text],
+    ARRAY[n.nodeid, n.nodeid],
+    'block_writes')
+FROM pg_dist_shard s
+JOIN pg_dist_placement p USING (shardid)
+JOIN pg_dist_node n USING (groupid)
+WHERE s.shardid = get_shard_id_for_distribution_column('pruning_cache_test', 1);
+SELECT public.wait_for_resource_cleanup();
+
+SELECT check_router_queries();
+EXECUTE select_by_id(1);
+SELECT count(*) FROM pruning_cache_test;
+
+-- dropping and recreating the table gives a new relation
+DROP TABLE pruning_cache_test;
+CREATE TABLE pruning_cache_test (id int PRIMARY KEY, value text);
+SELECT create_distributed_table('pruning_cache_test', 'id');
+INSERT INTO pruning_cache_test SELECT i, 'new value ' || i FROM generate_series(1, 20) i;
+
+SELECT check_router_queries();
+SELECT * FROM pruning_cache_test WHERE id = 1;
+
+-- the same queries work without the cache
+SET citus.enable_shard_pruning_cache TO off;
+SELECT check_router_queries();
+SELECT * FROM pruning_cache_test WHERE id = 1;
+RESET citus.enable_shard_pruning_cache;
+
+DEALLOCATE select_by_id;
+SET client_min_messages TO WARNING;
+DROP SCHEMA shard_pruning_cache CASCADE;